@@ -19,13 +19,23 @@
 #include "lk_sys.h"
 
 #include "inmode.h"
+#include "outmode.h"
 #include "detokenize.h"
+#include "preview.h"
+#include "search.h"
+#include "xref.h"
+#include "select.h"
+#include "verify.h"
+#include "dedup.h"
+#include "profile.h"
 
 // C includes
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <time.h>
 
 // cc65 includes
 
@@ -40,6 +50,69 @@
 #define FILENAME_INPUT_X			0	// user will start typing at position 0
 
 #define MAX_FILENAME_LEN			16	// CBM DOS defined
+#define MAX_SEARCH_TEXT_LEN			40
+#define XREF_FILENAME_SUFFIX		".xref"	// cross-reference report is saved as the output filename + this
+
+#define CONVERT_MAX_TIMED_FILES		64	// files in a batch whose times are kept, for the median
+#define CONVERT_LOG_FILENAME		"convert.log"	// what each text file was made from (see ConvertRecord)
+#define CONVERT_LOG_MAX_RECORDS		32
+
+#define PETSCII_FONT_FILENAME		"petscii.fnt"	// 2K font with PETSCII glyphs in 128-255 (see petscii_font[] in tokens.c)
+#define FONT_DATA_SIZE				(8*256)
+
+// tokenize menu entries for the dialects in this build (see detokenize.h)
+#ifndef NO_BASIC7
+	#define TOKENIZE_MENU_C128		", C128 BASIC 7.0 (7), 7.1 (1)"
+	#define TOKENIZE_KEYS_C128		"71"
+#else
+	#define TOKENIZE_MENU_C128		""
+	#define TOKENIZE_KEYS_C128		""
+#endif
+
+#ifndef NO_TFC3
+	#define TOKENIZE_MENU_TFC3		", TFC3 (T)"
+	#define TOKENIZE_KEYS_TFC3		"t"
+#else
+	#define TOKENIZE_MENU_TFC3		""
+	#define TOKENIZE_KEYS_TFC3		""
+#endif
+
+#ifndef NO_GRAPHICS52
+	#define TOKENIZE_MENU_GRAPHICS52	", Graphics 52 (G)"
+	#define TOKENIZE_KEYS_GRAPHICS52	"g"
+#else
+	#define TOKENIZE_MENU_GRAPHICS52	""
+	#define TOKENIZE_KEYS_GRAPHICS52	""
+#endif
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+// what the conversion log keeps about a text file: the program it was made from, and the options it was made with
+typedef struct ConvertRecord
+{
+	char		in_name_[MAX_FILENAME_LEN+1];
+	char		out_name_[MAX_FILENAME_LEN+1];
+	uint32_t	hash_;			// content address of the program (see Dedup_HashFile)
+	uint16_t	lines_;
+	uint16_t	start_;
+	uint8_t		flags_;			// DETOKENIZE_FLAG_xxx options
+	bool		with_xref_;
+} ConvertRecord;
+
+// counts and times of the files in a batch
+typedef struct ConvertBatch
+{
+	uint16_t	num_files_;
+	uint16_t	num_failed_;
+	uint16_t	num_skipped_;	// unchanged since they were last converted
+	uint8_t		num_timed_;
+	uint8_t		last_error_;	// ERROR_xxx code of the last file that could not be converted
+	clock_t		slowest_;
+	clock_t		ticks_[CONVERT_MAX_TIMED_FILES];	// time each converted file took, kept sorted
+} ConvertBatch;
+
 
 /*****************************************************************************/
 /*                          File-Scope Variables                             */
@@ -49,6 +122,12 @@ static char			in_filename_buf[MAX_FILENAME_LEN+1];
 static char*		in_filename = in_filename_buf;
 static char			out_filename_buf[MAX_FILENAME_LEN+1];
 static char*		out_filename = out_filename_buf;
+static char			xref_filename[MAX_FILENAME_LEN+1];
+static char			search_text_buf[MAX_SEARCH_TEXT_LEN+1];
+static char*		search_text = search_text_buf;
+static ConvertBatch		convert_batch;
+static ConvertRecord*	convert_log;		// the conversion log, while converting. NULL if there was no memory for it.
+static uint8_t			convert_log_count;
 
 /*****************************************************************************/
 /*                             Global Variables                              */
@@ -64,6 +143,61 @@ static char*		out_filename = out_filename_buf;
 // returns false if no string built.
 bool GetStringFromUser(char* the_buffer, int8_t the_max_length, int8_t x, int8_t y);
 
+// wait for the user to type one of the (lower case) characters in the_choices, in upper or lower case
+// returns the lower case version of the character typed
+char GetChoiceFromUser(char* the_choices);
+
+// load the PETSCII font from disk, and make it the active font
+// returns false if the font file could not be read
+bool LoadPetsciiFont(void);
+
+// print the size and timing results of a conversion
+void PrintConvertStats(ConvertStats* the_stats, uint8_t flags);
+
+// search the input file for search_text, then offer to search more files for the same text
+void SearchFiles(void);
+
+// save the cross-reference report next to the converted file
+// returns false if the report file could not be written
+bool SaveXrefReport(Xref* the_xref);
+
+// detect the BASIC dialect of the input file from the tokens it uses, and report it
+// falls back on the start address if the file can't be read again
+basic_t DetectDialect(int16_t cbm_addr);
+
+// ask which BASIC to tokenize for, then turn the text file in_filename into a program file named out_filename
+// returns an ERROR_xxx code
+uint8_t TokenizeFile(void);
+
+// check that the input file comes back unchanged from a round trip through text, then offer to check more files
+void VerifyFiles(uint8_t flags);
+
+// fingerprint the input file and any others the user names, then list which ones are copies, and which to convert
+void FindDuplicates(void);
+
+// open in_filename and read the program's start address from its first 2 bytes
+// returns an ERROR_xxx code. on success, *in_file_p is open, positioned at the first line.
+uint8_t OpenProgramFile(FILE** in_file_p, int16_t* cbm_addr_p);
+
+// convert in_filename to a text file named out_filename, saving a cross-reference next to it if with_xref
+// returns an ERROR_xxx code
+uint8_t ConvertFile(uint8_t flags, bool with_xref);
+
+// read the conversion log from disk. a missing log is an empty one.
+void LoadConvertLog(void);
+
+// write the conversion log back to disk, and free it
+// returns false if the log could not be written
+bool SaveConvertLog(void);
+
+// convert in_filename to out_filename, unless the log shows out_filename is already its text, with these options.
+// counts the file, and shows what was done with it.
+void ConvertChangedFile(uint8_t flags, bool with_xref);
+
+// convert the input file, then offer to convert more with the same options, and show how long each took
+// returns ERROR_NO_ERROR, or the ERROR_xxx code of the last file that could not be converted
+uint8_t ConvertFiles(uint8_t flags, bool with_xref);
+
 
 /*****************************************************************************/
 /*                       Private Function Definitions                        */
@@ -183,6 +317,788 @@ bool GetStringFromUser(char* the_buffer, int8_t the_max_length, int8_t start_x,
 }
 
 
+// wait for the user to type one of the (lower case) characters in the_choices, in upper or lower case
+// returns the lower case version of the character typed
+char GetChoiceFromUser(char* the_choices)
+{
+	char		the_char;
+	
+	do
+	{
+		the_char = tolower(getchar());
+	} while (the_char == '\0' || strchr(the_choices, the_char) == NULL);
+	
+	return the_char;
+}
+
+
+// load the PETSCII font from disk, and make it the active font
+// returns false if the font file could not be read
+bool LoadPetsciiFont(void)
+{
+	FILE*		the_file;
+	char*		the_font_data;
+	bool		success = false;
+	
+	the_font_data = (char*)malloc(FONT_DATA_SIZE);
+	
+	if (the_font_data == NULL)
+	{
+		return false;
+	}
+	
+	the_file = fopen(PETSCII_FONT_FILENAME, "r");
+	
+	if (the_file != NULL)
+	{
+		if (fread(the_font_data, 1, FONT_DATA_SIZE, the_file) == FONT_DATA_SIZE)
+		{
+			success = Text_UpdateFontData(the_font_data);
+		}
+		
+		fclose(the_file);
+	}
+	
+	free(the_font_data);
+	
+	return success;
+}
+
+
+// print the size and timing results of a conversion
+void PrintConvertStats(ConvertStats* the_stats, uint8_t flags)
+{
+	uint32_t	the_ratio = 0;
+	uint32_t	the_keywords = the_stats->lexer_stats_.prefixed_keywords_;
+	uint8_t		i;
+	
+	for (i = 0; i < 128; i++)
+	{
+		the_keywords += the_stats->lexer_stats_.keyword_uses_[i];
+	}
+	
+	// LOGIC: cc65 has no floating point, so ratio is shown as a percentage of the tokenized size
+	if (the_stats->bytes_in_ > 0)
+	{
+		the_ratio = (the_stats->bytes_out_ * 100) / the_stats->bytes_in_;
+	}
+	
+	if (flags & DETOKENIZE_FLAG_SUPERBASIC)
+	{
+		printf("Mode: SuperBASIC, %u lines could not be translated and were kept as REMs \n", the_stats->rem_lines_);
+	}
+	else if (flags & DETOKENIZE_FLAG_PETSCII_FONT)
+	{
+		printf("Mode: PETSCII font \n");
+	}
+	else
+	{
+		printf("Mode: escapes \n");
+	}
+	
+	printf("%u lines, %lu bytes in, %lu bytes out (%lu%%) \n", the_stats->lines_, (unsigned long)the_stats->bytes_in_, (unsigned long)the_stats->bytes_out_, (unsigned long)the_ratio);
+	printf("Time: %lu ticks (%lu ticks/sec) \n", (unsigned long)the_stats->ticks_, (unsigned long)CLOCKS_PER_SEC);
+	printf("%lu keywords (%u C128 prefixed), %lu chars in strings, %u bad tokens \n", (unsigned long)the_keywords, the_stats->lexer_stats_.prefixed_keywords_, (unsigned long)the_stats->lexer_stats_.string_chars_, the_stats->lexer_stats_.bad_tokens_);
+}
+
+
+// search the input file for search_text, then offer to search more files for the same text
+void SearchFiles(void)
+{
+	int16_t		the_count;
+	
+	do
+	{
+		printf("Searching %s... \n", in_filename);
+		the_count = Search_File(in_filename, search_text);
+		
+		if (the_count < 0)
+		{
+			printf("Error: could not read file, or could not translate search text. \n");
+		}
+		
+		printf("\nSearch another file (Y/N)? \n");
+		
+		if (GetChoiceFromUser("yn") == 'n')
+		{
+			return;
+		}
+		
+		Text_ClearScreen(COLOR_BRIGHT_WHITE, COLOR_BLACK);
+		printf("Enter filename of BASIC program to search: \n");
+		
+	} while (GetStringFromUser(in_filename, MAX_FILENAME_LEN, FILENAME_INPUT_X, FILENAME_INPUT_Y) == true);
+}
+
+
+// save the cross-reference report next to the converted file
+// returns false if the report file could not be written
+bool SaveXrefReport(Xref* the_xref)
+{
+	FILE*		the_file;
+	uint8_t		the_len;
+	bool		the_result;
+	
+	// the output name is cut short if needed, so the suffix still fits in a CBM DOS filename
+	the_len = strlen(out_filename);
+	
+	if (the_len > MAX_FILENAME_LEN - (sizeof(XREF_FILENAME_SUFFIX) - 1))
+	{
+		the_len = MAX_FILENAME_LEN - (sizeof(XREF_FILENAME_SUFFIX) - 1);
+	}
+	
+	memcpy(xref_filename, out_filename, the_len);
+	strcpy(&xref_filename[the_len], XREF_FILENAME_SUFFIX);
+	
+	the_file = fopen(xref_filename, "w");
+	
+	if (the_file == NULL)
+	{
+		return false;
+	}
+	
+	the_result = Xref_WriteReport(the_xref, the_file);
+	fclose(the_file);
+	
+	return the_result;
+}
+
+
+// detect the BASIC dialect of the input file from the tokens it uses, and report it
+// falls back on the start address if the file can't be read again
+basic_t DetectDialect(int16_t cbm_addr)
+{
+	FILE*		the_file;
+	basic_t		the_dialect;
+	int			the_confidence;
+	
+	// LOGIC:
+	//   there is no fseek, so the file is opened a second time for detection. it only follows the line links and
+	//   looks at token bytes, and stops early once one dialect clearly wins, so it costs far less than converting.
+	
+	the_file = fopen(in_filename, "r");
+	
+	if (the_file == NULL || fgetc(the_file) < 0 || fgetc(the_file) < 0)
+	{
+		if (the_file) fclose(the_file);
+		the_dialect = selectbasic(cbm_addr);
+		printf("Dialect: %s (from start address) \n", basicname(the_dialect));
+		return the_dialect;
+	}
+	
+	the_dialect = detectbasic(the_file, cbm_addr, &the_confidence);
+	fclose(the_file);
+	
+	printf("Dialect: %s (%d%% of tokens recognized) \n", basicname(the_dialect), the_confidence);
+	
+	return the_dialect;
+}
+
+
+// ask which BASIC to tokenize for, then turn the text file in_filename into a program file named out_filename
+// returns an ERROR_xxx code
+uint8_t TokenizeFile(void)
+{
+	FILE*		in_file;
+	FILE*		out_file;
+	uint16_t	cbm_addr;
+	uint16_t	the_line_count;
+	uint8_t		the_error;
+	basic_t		the_dialect;
+	
+	// LOGIC:
+	//   a text file has no start address to guess the dialect from, so the user picks the machine. the start address
+	//   is the one that machine's BASIC loads programs to, so the links in the saved program are right without a relink.
+	printf("\nTokenize for: C64 (2), VIC-20 (V)" TOKENIZE_MENU_C128 TOKENIZE_MENU_TFC3 TOKENIZE_MENU_GRAPHICS52 "? \n");
+	
+	switch (GetChoiceFromUser("2v" TOKENIZE_KEYS_C128 TOKENIZE_KEYS_TFC3 TOKENIZE_KEYS_GRAPHICS52))
+	{
+		case 'v':
+			the_dialect = Basic2;
+			cbm_addr = 0x1001;
+			break;
+		case '7':
+			the_dialect = Basic7;
+			cbm_addr = 0x1C01;
+			break;
+		case '1':
+			the_dialect = Basic71;
+			cbm_addr = 0x1C01;
+			break;
+		case 't':
+			the_dialect = TFC3;
+			cbm_addr = 0x0801;
+			break;
+		case 'g':
+			the_dialect = Graphics52;
+			cbm_addr = 0x0401;
+			break;
+		default:
+			the_dialect = Basic2;
+			cbm_addr = 0x0801;
+			break;
+	}
+	
+	in_file = fopen(in_filename, "r");
+	
+	if (in_file == NULL)
+	{
+		printf("Error: could not open file for reading. \n");
+		return ERROR_UNABLE_TO_OPEN_INPUT_FILE;
+	}
+	
+	out_file = fopen(out_filename, "w");
+	
+	if (out_file == NULL)
+	{
+		fclose(in_file);
+		printf("Error: could not open file for writing. \n");
+		return ERROR_UNABLE_TO_OPEN_OUTPUT_FILE;
+	}
+	
+	printf("Tokenizing file for %s... \n", basicname(the_dialect));
+	the_error = outconvert(in_file, out_file, cbm_addr, the_dialect, &the_line_count);
+	
+	fclose(in_file);
+	fclose(out_file);
+	
+	if (the_error != ERROR_NO_ERROR)
+	{
+		printf("Error: could not tokenize text line %u. \n", the_line_count);
+		return the_error;
+	}
+	
+	printf("Done \n");
+	printf("%u text lines read, program starts at $%04x \n", the_line_count, cbm_addr);
+	
+	return ERROR_NO_ERROR;
+}
+
+
+// check that the input file comes back unchanged from a round trip through text, then offer to check more files
+void VerifyFiles(uint8_t flags)
+{
+	VerifyResult	the_result;
+	clock_t			the_ticks;
+	uint16_t		num_files = 0;
+	uint16_t		num_failed = 0;
+	
+	do
+	{
+		printf("Verifying %s... \n", in_filename);
+		
+		the_ticks = clock();
+		Verify_File(in_filename, flags, &the_result);
+		the_ticks = clock() - the_ticks;
+		
+		++num_files;
+		
+		switch (the_result.status_)
+		{
+			case VERIFY_OK:
+				printf("%s: %u lines OK (%s, %lu ticks) \n", in_filename, the_result.lines_, basicname(the_result.mode_), (unsigned long)the_ticks);
+				break;
+				
+			case VERIFY_EQUIVALENT:
+				printf("%s: %u lines OK, %u list the same but not byte for byte (%s, %lu ticks) \n", in_filename, the_result.lines_, the_result.equivalent_lines_, basicname(the_result.mode_), (unsigned long)the_ticks);
+				break;
+				
+			case VERIFY_MISMATCH:
+				++num_failed;
+				printf("%s: line %u differs at byte %u (file offset %lu): ", in_filename, the_result.line_number_, the_result.column_, (unsigned long)the_result.file_offset_);
+				
+				if (the_result.original_byte_ < 0)
+				{
+					printf("line ends, came back with $%02x \n", the_result.result_byte_);
+				}
+				else if (the_result.result_byte_ < 0)
+				{
+					printf("$%02x, came back with line ended \n", the_result.original_byte_);
+				}
+				else
+				{
+					printf("$%02x came back as $%02x \n", the_result.original_byte_, the_result.result_byte_);
+				}
+				break;
+				
+			case VERIFY_BAD_TEXT:
+				++num_failed;
+				printf("%s: line %u could not be tokenized again \n", in_filename, the_result.line_number_);
+				break;
+				
+			default:
+				++num_failed;
+				printf("%s: could not read file, or not a BASIC program \n", in_filename);
+				break;
+		}
+		
+		printf("\nVerify another file (Y/N)? \n");
+		
+		if (GetChoiceFromUser("yn") == 'n')
+		{
+			break;
+		}
+		
+		Text_ClearScreen(COLOR_BRIGHT_WHITE, COLOR_BLACK);
+		printf("%u files verified, %u failed \n", num_files, num_failed);
+		printf("Enter filename of BASIC program to verify: \n");
+		
+	} while (GetStringFromUser(in_filename, MAX_FILENAME_LEN, FILENAME_INPUT_X, FILENAME_INPUT_Y + 1) == true);
+	
+	printf("%u files verified, %u failed \n", num_files, num_failed);
+}
+
+
+// fingerprint the input file and any others the user names, then list which ones are copies, and which to convert
+void FindDuplicates(void)
+{
+	Dedup*			the_dedup;
+	DedupMatch		the_match;
+	DedupProgram*	the_program;
+	uint8_t			i;
+	uint8_t			j;
+	uint8_t			the_copies;
+	
+	the_dedup = Dedup_New();
+	
+	if (the_dedup == NULL)
+	{
+		printf("Error: not enough memory. \n");
+		return;
+	}
+	
+	do
+	{
+		switch (Dedup_AddFile(the_dedup, in_filename, &the_match))
+		{
+			case DEDUP_NEW:
+				printf("%s: new \n", in_filename);
+				break;
+				
+			case DEDUP_EXACT:
+				printf("%s: same as %s \n", in_filename, the_dedup->programs_[the_match.program_].name_);
+				break;
+				
+			case DEDUP_NEAR:
+				printf("%s: %u%% like %s \n", in_filename, the_match.percent_, the_dedup->programs_[the_match.program_].name_);
+				break;
+				
+			default:
+				printf("%s: could not read file, not a BASIC program, or too many files \n", in_filename);
+				break;
+		}
+		
+		printf("\nCheck another file (Y/N)? \n");
+		
+		if (GetChoiceFromUser("yn") == 'n')
+		{
+			break;
+		}
+		
+		Text_ClearScreen(COLOR_BRIGHT_WHITE, COLOR_BLACK);
+		printf("%u files, %u different programs so far \n", the_dedup->num_programs_, the_dedup->num_clusters_);
+		printf("Enter filename of BASIC program to check: \n");
+		
+	} while (GetStringFromUser(in_filename, MAX_FILENAME_LEN, FILENAME_INPUT_X, FILENAME_INPUT_Y + 1) == true);
+	
+	// one file of each cluster is enough to convert: the first one seen
+	Text_ClearScreen(COLOR_BRIGHT_WHITE, COLOR_BLACK);
+	printf("%u files, %u different programs. Files to convert: \n", the_dedup->num_programs_, the_dedup->num_clusters_);
+	
+	for (i = 0; i < the_dedup->num_programs_; i++)
+	{
+		the_program = &the_dedup->programs_[i];
+		
+		if (the_program->representative_ != i)
+		{
+			continue;
+		}
+		
+		for (the_copies = 0, j = i + 1; j < the_dedup->num_programs_; j++)
+		{
+			if (the_dedup->programs_[j].representative_ == i)
+			{
+				++the_copies;
+			}
+		}
+		
+		printf("  %s (%u lines, %u copies) \n", the_program->name_, the_program->lines_, the_copies);
+	}
+	
+	if (the_dedup->out_of_memory_)
+	{
+		printf("Warning: memory ran out; some near duplicates may have been missed. \n");
+	}
+	
+	Dedup_Destroy(&the_dedup);
+}
+
+
+// open in_filename and read the program's start address from its first 2 bytes
+// returns an ERROR_xxx code. on success, *in_file_p is open, positioned at the first line.
+uint8_t OpenProgramFile(FILE** in_file_p, int16_t* cbm_addr_p)
+{
+	FILE*		in_file;
+	int16_t		addr_hi;
+	int16_t		addr_lo;
+
+	// try to open input file for reading
+	printf("Attempting to open input file... \n");
+	in_file = fopen(in_filename, "r");
+	
+	if (in_file == NULL)
+	{
+		printf("Error: could not open file for reading. \n");
+		return ERROR_UNABLE_TO_OPEN_INPUT_FILE;
+	}
+
+	// get first 2 bytes of input file - used to determine what kind of BASIC it is (2.0 vs 7.0, etc.)
+	addr_lo = fgetc(in_file); // low byte
+
+	if (addr_lo < 0)
+	{
+		printf("Error getting 1st byte in file \n");
+		fclose(in_file);
+		return ERROR_UNABLE_TO_OPEN_OUTPUT_FILE;
+	}
+	
+	addr_hi = fgetc(in_file); // low byte
+
+	if (addr_hi < 0)
+	{
+		printf("Error getting 2nd byte in file \n");
+		fclose(in_file);
+		return ERROR_UNABLE_TO_OPEN_OUTPUT_FILE;
+	}
+	
+	*cbm_addr_p = addr_lo + (addr_hi << 8);
+	*in_file_p = in_file;
+
+	printf("initial address=%x (%x, %x) \n", *cbm_addr_p, addr_hi, addr_lo);
+	
+	return ERROR_NO_ERROR;
+}
+
+
+// convert in_filename to a text file named out_filename, saving a cross-reference next to it if with_xref
+// returns an ERROR_xxx code
+uint8_t ConvertFile(uint8_t flags, bool with_xref)
+{
+	FILE*			in_file;
+	FILE*			out_file;
+	int16_t			cbm_addr;
+	uint8_t			error_code;
+	basic_t			the_dialect;
+	ConvertStats	the_stats;
+	Xref*			the_xref = NULL;
+
+	error_code = OpenProgramFile(&in_file, &cbm_addr);
+	
+	if (error_code != ERROR_NO_ERROR)
+	{
+		return error_code;
+	}
+
+	the_dialect = DetectDialect(cbm_addr);
+
+	// try to open output for writing
+	out_file = fopen(out_filename, "w");
+
+	if (out_file == NULL)
+	{
+		printf("Error: could not open file for writing. \n");
+		fclose(in_file);
+		return ERROR_UNABLE_TO_OPEN_OUTPUT_FILE;
+	}
+	
+	// each file gets its own cross-reference, saved next to its own text file
+	if (with_xref)
+	{
+		the_xref = Xref_New();
+	}
+	
+	/* Now convert the file to text */
+	printf("Converting file... \n");
+	error_code = inconvert(in_file, out_file, cbm_addr, the_dialect, flags, &the_stats, the_xref);
+
+	/* Close files */
+	fclose(in_file);
+	fclose(out_file);
+	
+	// a bad program ends this file only: the lines before the problem are in the text file, but there is no report
+	if (error_code != ERROR_NO_ERROR)
+	{
+		printf("Error: not a valid BASIC program, stopped after %u lines. \n", the_stats.lines_);
+		Xref_Destroy(&the_xref);
+		return error_code;
+	}
+	
+	printf("Done \n");
+	PrintConvertStats(&the_stats, flags);
+	PROFILE_PRINT();
+	
+	if (the_xref != NULL)
+	{
+		if (SaveXrefReport(the_xref))
+		{
+			printf("Cross-reference saved as %s \n", xref_filename);
+		}
+		else
+		{
+			printf("Error: could not save cross-reference. \n");
+		}
+		
+		Xref_Destroy(&the_xref);
+	}
+	
+	return ERROR_NO_ERROR;
+}
+
+
+// read the conversion log from disk. a missing log is an empty one.
+void LoadConvertLog(void)
+{
+	FILE*		the_file;
+	uint8_t		i;
+	
+	convert_log = (ConvertRecord*)calloc(CONVERT_LOG_MAX_RECORDS, sizeof(ConvertRecord));
+	convert_log_count = 0;
+	
+	if (convert_log == NULL)
+	{
+		printf("Warning: not enough memory for %s, converting every file. \n", CONVERT_LOG_FILENAME);
+		return;
+	}
+	
+	the_file = fopen(CONVERT_LOG_FILENAME, "r");
+	
+	if (the_file == NULL)
+	{
+		return;
+	}
+	
+	convert_log_count = fread(convert_log, sizeof(ConvertRecord), CONVERT_LOG_MAX_RECORDS, the_file);
+	fclose(the_file);
+	
+	// the names are copied into in_filename and out_filename, so make sure a damaged log can't overrun them
+	for (i = 0; i < convert_log_count; i++)
+	{
+		convert_log[i].in_name_[MAX_FILENAME_LEN] = '\0';
+		convert_log[i].out_name_[MAX_FILENAME_LEN] = '\0';
+	}
+}
+
+
+// write the conversion log back to disk, and free it
+// returns false if the log could not be written
+bool SaveConvertLog(void)
+{
+	FILE*		the_file;
+	bool		the_result;
+	
+	if (convert_log == NULL)
+	{
+		return true;
+	}
+	
+	the_file = fopen(CONVERT_LOG_FILENAME, "w");
+	the_result = (the_file != NULL);
+	
+	if (the_file != NULL)
+	{
+		the_result = (fwrite(convert_log, sizeof(ConvertRecord), convert_log_count, the_file) == convert_log_count);
+		fclose(the_file);
+	}
+	
+	free(convert_log);
+	convert_log = NULL;
+	
+	return the_result;
+}
+
+
+// convert in_filename to out_filename, unless the log shows out_filename is already its text, with these options.
+// counts the file, and shows what was done with it.
+void ConvertChangedFile(uint8_t flags, bool with_xref)
+{
+	ConvertRecord*	the_record = NULL;
+	FILE*			the_file;
+	clock_t			the_ticks;
+	uint32_t		the_hash;
+	uint16_t		the_lines;
+	uint16_t		the_start;
+	bool			have_hash;
+	uint8_t			error_code;
+	uint8_t			i;
+	
+	// LOGIC:
+	//   the program is hashed first, which only reads it: far less work than converting and writing it. if the log
+	//   says the text file was made from a program with the same hash, line count and start address, with the same
+	//   options, and the text file is still there, it is left alone.
+	//   a program that can't be hashed (it has no end yet, say, as it is still being copied) is converted as before,
+	//   but not logged, so it is converted again next time.
+	
+	the_ticks = clock();
+	have_hash = Dedup_HashFile(in_filename, &the_hash, &the_lines, &the_start);
+	
+	for (i = 0; i < convert_log_count; i++)
+	{
+		if (strcmp(convert_log[i].out_name_, out_filename) == 0)
+		{
+			the_record = &convert_log[i];
+			break;
+		}
+	}
+	
+	++convert_batch.num_files_;
+	
+	if (have_hash && the_record != NULL && the_record->hash_ == the_hash && the_record->lines_ == the_lines &&
+	    the_record->start_ == the_start && the_record->flags_ == flags && the_record->with_xref_ == with_xref)
+	{
+		the_file = fopen(out_filename, "r");
+		
+		if (the_file != NULL)
+		{
+			fclose(the_file);
+			++convert_batch.num_skipped_;
+			printf("%s: unchanged since it was converted to %s, skipped \n", in_filename, out_filename);
+			return;
+		}
+	}
+	
+	error_code = ConvertFile(flags, with_xref);
+	the_ticks = clock() - the_ticks;
+	
+	// a failed file is not logged as converted, so it is tried again next time. its record, if it has one, stays in
+	// the log (so checking all logged files still retries it), but with no lines, which no program hashes to.
+	if (error_code != ERROR_NO_ERROR)
+	{
+		++convert_batch.num_failed_;
+		convert_batch.last_error_ = error_code;
+		printf("%s: not converted (error %u) \n", in_filename, error_code);
+		
+		if (the_record != NULL)
+		{
+			the_record->lines_ = 0;
+		}
+		return;
+	}
+	
+	printf("%s: converted to %s (%lu ticks) \n", in_filename, out_filename, (unsigned long)the_ticks);
+	
+	if (the_ticks > convert_batch.slowest_)
+	{
+		convert_batch.slowest_ = the_ticks;
+	}
+	
+	if (convert_batch.num_timed_ < CONVERT_MAX_TIMED_FILES)
+	{
+		for (i = convert_batch.num_timed_++; i > 0 && convert_batch.ticks_[i - 1] > the_ticks; i--)
+		{
+			convert_batch.ticks_[i] = convert_batch.ticks_[i - 1];
+		}
+		
+		convert_batch.ticks_[i] = the_ticks;
+	}
+	
+	// a full log keeps what it has: files past it are just converted every time
+	if (have_hash == false || (the_record == NULL && (convert_log == NULL || convert_log_count == CONVERT_LOG_MAX_RECORDS)))
+	{
+		return;
+	}
+	
+	if (the_record == NULL)
+	{
+		the_record = &convert_log[convert_log_count++];
+	}
+	
+	strcpy(the_record->in_name_, in_filename);
+	strcpy(the_record->out_name_, out_filename);
+	the_record->hash_ = the_hash;
+	the_record->lines_ = the_lines;
+	the_record->start_ = the_start;
+	the_record->flags_ = flags;
+	the_record->with_xref_ = with_xref;
+}
+
+
+// convert the input file, then offer to convert more with the same options, and show how long each took
+// returns ERROR_NO_ERROR, or the ERROR_xxx code of the last file that could not be converted
+uint8_t ConvertFiles(uint8_t flags, bool with_xref)
+{
+	uint8_t		i;
+	
+	// LOGIC:
+	//   the program, its token tables and the font stay loaded for the whole batch, so each file after the first only
+	//   costs its own conversion. a file that can't be converted is reported, and the batch goes on. the log is
+	//   saved at the end whatever happened to each file, so the next run only converts what changed or failed.
+	//   each file's time is from hashing it to saving its cross-reference. the times of the first
+	//   CONVERT_MAX_TIMED_FILES that converted are kept sorted, for the median at the end.
+	//   once the user has named all their files, every file in the log can be checked again as often as they like:
+	//   only the ones that changed since are converted.
+	
+	memset(&convert_batch, 0, sizeof(ConvertBatch));
+	LoadConvertLog();
+	
+	do
+	{
+		ConvertChangedFile(flags, with_xref);
+		
+		printf("\nConvert another file (Y/N)? \n");
+		
+		if (GetChoiceFromUser("yn") == 'n')
+		{
+			break;
+		}
+		
+		Text_ClearScreen(COLOR_BRIGHT_WHITE, COLOR_BLACK);
+		printf("%u files converted, %u unchanged, %u failed \n", convert_batch.num_files_ - convert_batch.num_skipped_ - convert_batch.num_failed_, convert_batch.num_skipped_, convert_batch.num_failed_);
+		printf("Enter filename of BASIC program to convert: \n");
+		
+		if (GetStringFromUser(in_filename, MAX_FILENAME_LEN, FILENAME_INPUT_X, FILENAME_INPUT_Y + 1) == false)
+		{
+			break;
+		}
+		
+		printf("\nEnter filename to save text version under: \n");
+		
+	} while (GetStringFromUser(out_filename, MAX_FILENAME_LEN, FILENAME_INPUT_X, FILENAME_INPUT_Y + 3) == true);
+	
+	if (convert_log_count > 0)
+	{
+		printf("\nCheck all %u logged files for changes (Y/N)? \n", convert_log_count);
+	}
+	
+	while (convert_log_count > 0 && GetChoiceFromUser("yn") == 'y')
+	{
+		Text_ClearScreen(COLOR_BRIGHT_WHITE, COLOR_BLACK);
+		
+		for (i = 0; i < convert_log_count; i++)
+		{
+			strcpy(in_filename, convert_log[i].in_name_);
+			strcpy(out_filename, convert_log[i].out_name_);
+			ConvertChangedFile(flags, with_xref);
+		}
+		
+		printf("\nCheck them again (Y/N)? \n");
+	}
+	
+	if (SaveConvertLog() == false)
+	{
+		printf("Error: could not save %s. \n", CONVERT_LOG_FILENAME);
+	}
+	
+	printf("%u files converted, %u unchanged, %u failed \n", convert_batch.num_files_ - convert_batch.num_skipped_ - convert_batch.num_failed_, convert_batch.num_skipped_, convert_batch.num_failed_);
+	
+	if (convert_batch.num_timed_ > 1)
+	{
+		printf("Time per file: median %lu ticks, slowest %lu ticks \n", (unsigned long)convert_batch.ticks_[convert_batch.num_timed_ / 2], (unsigned long)convert_batch.slowest_);
+	}
+	
+	return convert_batch.last_error_;
+}
+
+
 /*****************************************************************************/
 /*                        Public Function Definitions                        */
 /*****************************************************************************/
@@ -207,19 +1123,25 @@ int main(void)
 {
 // 	uint8_t		i;
 
-	FILE*		in_file;
-	FILE*		out_file;
+	FILE*		in_file = NULL;
 	int16_t		cbm_addr;
-	int16_t		addr_hi;
-	int16_t		addr_lo;
 	uint8_t		feedback_y = FILENAME_INPUT_Y-1; // for drawing instructions/getting input
 	uint8_t		error_code = ERROR_NO_ERROR;
+	uint8_t		detokenize_flags = DETOKENIZE_FLAG_NONE;
+	bool		with_xref = false;
+	basic_t		the_dialect;
+	char		the_mode;
 
 	// FLOW
 	//  ask user for a file name
-	//  try to open a file with that name
-	//  if file open works, add ".bas" to filename - the out file
-	//  detokenize the file, save as another file.
+	//  ask user whether to convert to a file, preview on screen, or search
+	//  if searching, get the search text, search the file (and any others the user names), and stop
+	//  if tokenizing, get the output filename and dialect, turn the text file into a program file, and stop
+	//  if verifying, check the file (and any others the user names) survives a round trip through text, and stop
+	//  if finding duplicates, fingerprint the file and any others the user names, list the ones to convert, and stop
+	//  if converting, detokenize the file, save as another file, then offer to convert more files with the same options
+	//  otherwise, try to open a file with that name, and detokenize lines straight to the screen as the user pages
+	//    through them
 	
 	
 // 	printf("main: start \n");
@@ -237,7 +1159,7 @@ int main(void)
 
 	// DO STUFF
 	// get filename from user
-	printf("Enter filename of BASIC program to convert to text: \n");
+	printf("Enter filename of BASIC program (or text file to tokenize): \n");
 
 	if (GetStringFromUser(in_filename, MAX_FILENAME_LEN, FILENAME_INPUT_X, ++feedback_y) == false)
 	{
@@ -246,78 +1168,138 @@ int main(void)
 		goto error;
 	}
 
-	// get output filename from user
-	printf("\nEnter filename to save text version under: \n\n"); // extra line spacing to get past input text
-	++feedback_y;
+	// ask whether to convert to a file, only preview the program on screen, search it, or tokenize a text file
+	printf("\nConvert to a text file (C), preview on screen (P), search (S), tokenize text (T), verify (V), or find duplicates (D)? \n");
+	feedback_y += 2;
+	the_mode = GetChoiceFromUser("cpstvd");
 
-	if (GetStringFromUser(out_filename, MAX_FILENAME_LEN, FILENAME_INPUT_X, ++feedback_y) == false)
+	if (the_mode == 's')
 	{
-		// user canceled out somehow
-		error_code = ERROR_FILENAME_ENTRY_ISSUE;
-		goto error;
+		printf("\nEnter text to search for (start with \" to search strings): \n\n");
+		++feedback_y;
+
+		if (GetStringFromUser(search_text, MAX_SEARCH_TEXT_LEN, FILENAME_INPUT_X, ++feedback_y) == false)
+		{
+			error_code = ERROR_FILENAME_ENTRY_ISSUE;
+			goto error;
+		}
+		
+		SearchFiles();
+		exit_with_wait(error_code);
 	}
 
+	if (the_mode == 'd')
+	{
+		FindDuplicates();
+		exit_with_wait(error_code);
+	}
 
-	// try to open input file for reading
-	printf("Attempting to open input file... \n");
-	in_file = fopen(in_filename, "r");
-	
-	if (in_file == NULL)
+	if (the_mode == 'c' || the_mode == 't')
 	{
-		printf("Error: could not open file for reading. \n");
-		error_code = ERROR_UNABLE_TO_OPEN_INPUT_FILE;
-		goto error;
+		// get output filename from user
+		if (the_mode == 't')
+		{
+			printf("\nEnter filename to save program under: \n\n");
+		}
+		else
+		{
+			printf("\nEnter filename to save text version under: \n\n");
+		}
+		
+		++feedback_y;	// extra line spacing to get past input text
+
+		if (GetStringFromUser(out_filename, MAX_FILENAME_LEN, FILENAME_INPUT_X, ++feedback_y) == false)
+		{
+			// user canceled out somehow
+			error_code = ERROR_FILENAME_ENTRY_ISSUE;
+			goto error;
+		}
+		
+		// text to program: nothing else to ask, the dialect is chosen by the user
+		if (the_mode == 't')
+		{
+			error_code = TokenizeFile();
+			exit_with_wait(error_code);
+		}
+
+		// optionally build a cross-reference of line targets and variables while converting
+		printf("\nAlso save a cross-reference of line targets and variables (Y/N)? \n");
+		
+		if (GetChoiceFromUser("yn") == 'y')
+		{
+			with_xref = true;
+		}
+
+		// optionally write the program as SuperBASIC source, ready to load on the F256, instead of as a listing
+		printf("\nWrite as F256 SuperBASIC source (Y/N)? \n");
+		
+		if (GetChoiceFromUser("yn") == 'y')
+		{
+			detokenize_flags |= DETOKENIZE_FLAG_SUPERBASIC;
+		}
 	}
 
-	// get first 2 bytes of input file - used to determine what kind of BASIC it is (2.0 vs 7.0, etc.)
-	addr_lo = fgetc(in_file); // low byte
+	// optionally switch to the PETSCII font, so quoted characters can be written as single font codes
+	// SuperBASIC strings are ASCII, so there is nothing to ask for SuperBASIC source
+	if ((detokenize_flags & DETOKENIZE_FLAG_SUPERBASIC) == 0)
+	{
+		printf("\nUse PETSCII font for quoted characters (Y/N)? \n");
+		
+		if (GetChoiceFromUser("yn") == 'y')
+		{
+			if (LoadPetsciiFont())
+			{
+				detokenize_flags |= DETOKENIZE_FLAG_PETSCII_FONT;
+			}
+			else
+			{
+				printf("Could not load %s, using escapes \n", PETSCII_FONT_FILENAME);
+			}
+		}
+	}
 
-	if (addr_lo < 0)
+	// verify: each file is opened and checked by itself, line by line, with nothing written to storage
+	if (the_mode == 'v')
 	{
-		printf("Error getting 1st byte in file \n");
-		error_code = ERROR_UNABLE_TO_OPEN_OUTPUT_FILE;
-		goto error;
+		VerifyFiles(detokenize_flags);
+		exit_with_wait(error_code);
 	}
-	
-	addr_hi = fgetc(in_file); // low byte
 
-	if (addr_hi < 0)
+	// convert: the files are opened one at a time, and the options asked above are used for all of them
+	if (the_mode == 'c')
 	{
-		printf("Error getting 2nd byte in file \n");
-		error_code = ERROR_UNABLE_TO_OPEN_OUTPUT_FILE;
-		goto error;
+		error_code = ConvertFiles(detokenize_flags, with_xref);
+		exit_with_wait(error_code);
 	}
-	
-	cbm_addr = addr_lo + (addr_hi << 8);
 
-	printf("initial address=%x (%x, %x) \n", cbm_addr, addr_hi, addr_lo);
+	error_code = OpenProgramFile(&in_file, &cbm_addr);
+	
+	if (error_code != ERROR_NO_ERROR)
+	{
+		exit_with_wait(error_code);
+	}
 
-	// try to open output for writing
-	out_file = fopen(out_filename, "w");
+	the_dialect = DetectDialect(cbm_addr);
 
-	if (out_file == NULL)
+	// preview: detokenize straight to the screen, nothing is written to storage
+	if (the_mode == 'p')
 	{
-		printf("Error: could not open file for writing. \n");
-		error_code = ERROR_UNABLE_TO_OPEN_OUTPUT_FILE;
-		goto error;
+		if (Preview_Show(in_filename, in_file, (uint16_t)cbm_addr, the_dialect, detokenize_flags) == false)
+		{
+			printf("Error: not a BASIC program start address. \n");
+			error_code = ERROR_INVALID_BASIC_START_ADDRESS;
+			goto error;
+		}
+		
+		fclose(in_file);
+		Text_ClearScreen(COLOR_BRIGHT_WHITE, COLOR_BLACK);
+		exit_with_wait(error_code);
 	}
-	
-	/* Now convert the file to text */
-	printf("Converting file... \n");
-	inconvert(in_file, out_file, cbm_addr);
 
-	/* Close files */
-	fclose(in_file);
-	fclose(out_file);
-	
-	printf("Done \n");
-	
-	exit_with_wait(error_code);
 	return 0;
 
 error:	
-	// check if either input or output file exists, and if so, try to close it so drive light goes out.
+	// check if the input file is open, and if so, try to close it so drive light goes out.
 	if (in_file)	fclose(in_file);
-	if (out_file)	fclose(out_file);
 	exit_with_wait(error_code);
 }
\ No newline at end of file
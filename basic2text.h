@@ -80,6 +80,7 @@
 #define ERROR_INVALID_BASIC_FILE										8
 #define ERROR_INVALID_BASIC_START_ADDRESS								9
 #define ERROR_SAVE_BUFFER_TOO_SMALL										10
+#define ERROR_INVALID_TEXT_LINE											11
 
 
 /*****************************************************************************/
@@ -0,0 +1,215 @@
+/*
+ * bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+/* about this program
+ *
+ * Benchmark harness for the conversion core, built for cc65's 6502 simulator (sim65) instead of the F256, so the
+ * target's code can be timed on any machine, in exact CPU cycles. See bench.sh for how it is built and run.
+ *
+ * It reads one program, and detokenizes it line by line, the same way inconvert() does, but without writing
+ * anything: the cycles counted are those of the conversion core, plus the startup and file reading around it. To
+ * take those out, it can also be run in read-only mode, which does everything but detokenize. bench.sh subtracts the
+ * cycles of the read-only run from those of the full run.
+ *
+ * It can also convert the way LineIndex_TextChunk() does: the whole program is read and its links walked first
+ * (index mode), then its lines are detokenized in chunks of BENCH_CHUNK_SIZE bytes of text (chunk mode). bench.sh
+ * subtracts the cycles of the index run from those of the chunk run.
+ *
+ * usage: bench <program file> read|convert|index|chunk [font]
+ * prints: <lines> <bytes read> <dialect>
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+
+// project includes
+#include "../detokenize.h"
+#include "../lineindex.h"
+#include "../select.h"
+
+// C includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define BENCH_CHUNK_SIZE	2048	// text buffer for chunk mode
+
+
+/*****************************************************************************/
+/*                          File-Scope Variables                             */
+/*****************************************************************************/
+
+// static because cc65 doesn't like creating that much on the stack.
+static char			bench_line[256];
+static char			bench_text[512];
+static char			bench_chunk[BENCH_CHUNK_SIZE];
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+// read the whole program into a LineIndex, and detokenize it in chunks if do_convert
+// returns EXIT_SUCCESS, or EXIT_FAILURE if the program could not be read
+int Bench_Chunked(FILE* the_file, uint16_t cbm_addr, bool do_convert, uint8_t the_flags);
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+
+// read the whole program into a LineIndex, and detokenize it in chunks if do_convert
+// returns EXIT_SUCCESS, or EXIT_FAILURE if the program could not be read
+int Bench_Chunked(FILE* the_file, uint16_t cbm_addr, bool do_convert, uint8_t the_flags)
+{
+	LineIndex*	the_index;
+	uint8_t*	the_line;
+	uint16_t	the_position = 0;
+	uint32_t	the_bytes = 2;
+	uint16_t	i;
+
+	the_index = LineIndex_New(the_file, cbm_addr, the_flags);
+
+	if (the_index == NULL)
+	{
+		printf("0 0 none\n");
+		return EXIT_FAILURE;
+	}
+
+	// the same bytes as the streaming runs count: each line's link, line number, data, and terminator
+	for (i = 0; i < the_index->num_lines_; i++)
+	{
+		the_line = LineIndex_GetLine(the_index, i);
+		the_bytes += (the_line[0] | (the_line[1] << 8)) - (cbm_addr + the_index->entries_[i].offset_);
+	}
+
+	if (do_convert)
+	{
+		while (LineIndex_TextChunk(the_index, &the_position, bench_chunk, BENCH_CHUNK_SIZE) > 0)
+		{
+		}
+	}
+
+	printf("%u %lu %s\n", the_index->num_lines_, (unsigned long)the_bytes, basicname(the_index->mode_));
+	LineIndex_Destroy(&the_index);
+
+	return EXIT_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+int main(int argc, char* argv[])
+{
+	FILE*		the_file;
+	uint16_t	cbm_addr;
+	uint16_t	nextadr;
+	int16_t		addr_lo;
+	int16_t		addr_hi;
+	uint8_t		the_len;
+	uint16_t	the_lines = 0;
+	uint32_t	the_bytes = 2;
+	bool		do_convert;
+	uint8_t		the_flags = DETOKENIZE_FLAG_NONE;
+	basic_t		the_dialect;
+	int			the_confidence;
+	int			the_result;
+
+	if (argc < 3)
+	{
+		printf("usage: bench <program file> read|convert|index|chunk [font] \n");
+		return EXIT_FAILURE;
+	}
+
+	do_convert = (strcmp(argv[2], "convert") == 0 || strcmp(argv[2], "chunk") == 0);
+
+	if (argc > 3 && strcmp(argv[3], "font") == 0)
+	{
+		the_flags |= DETOKENIZE_FLAG_PETSCII_FONT;
+	}
+
+	// LOGIC: detection is done in both runs, so its cycles cancel out and only the conversion is measured
+	the_file = fopen(argv[1], "rb");
+
+	if (the_file == NULL || (addr_lo = fgetc(the_file)) < 0 || (addr_hi = fgetc(the_file)) < 0)
+	{
+		printf("could not read %s \n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	cbm_addr = addr_lo + (addr_hi << 8);
+
+	// LineIndex detects the dialect itself, from the program in memory
+	if (strcmp(argv[2], "index") == 0 || strcmp(argv[2], "chunk") == 0)
+	{
+		the_result = Bench_Chunked(the_file, cbm_addr, do_convert, the_flags);
+		fclose(the_file);
+		return the_result;
+	}
+
+	the_dialect = detectbasic(the_file, cbm_addr, &the_confidence);
+	fclose(the_file);
+
+	the_file = fopen(argv[1], "rb");
+	fgetc(the_file);
+	fgetc(the_file);
+
+	while (true)
+	{
+		addr_lo = fgetc(the_file);
+		addr_hi = fgetc(the_file);
+
+		if (addr_lo < 0 || addr_hi < 0)
+		{
+			break;
+		}
+
+		nextadr = addr_lo + (addr_hi << 8);
+
+		// same checks as the converter: links go up, and a line is less than 256 bytes
+		if (nextadr <= cbm_addr || nextadr - cbm_addr >= 256)
+		{
+			break;
+		}
+
+		the_len = nextadr - cbm_addr - 2;
+
+		if (fread(bench_line, 1, the_len, the_file) != the_len)
+		{
+			break;
+		}
+
+		cbm_addr = nextadr;
+		the_bytes += the_len + 2;
+		++the_lines;
+
+		if (do_convert)
+		{
+			detokenize(bench_line, bench_text, the_dialect, the_flags);
+		}
+	}
+
+	fclose(the_file);
+
+	printf("%u %lu %s\n", the_lines, (unsigned long)the_bytes, basicname(the_dialect));
+
+	return EXIT_SUCCESS;
+}
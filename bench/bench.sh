@@ -0,0 +1,118 @@
+#!/bin/sh
+#
+# bench.sh
+#
+#  Created on: Oct 18, 2026
+#      Author: micahbly
+#
+# Times the conversion core in 65C02 CPU cycles, under cc65's simulator (sim65), over a set of program files.
+#
+# Each file is run through bench.prg twice: once only reading it, once also detokenizing it. The difference in
+# cycles is the cost of the conversion itself. Results are shown per file, then as the median (p50) and 99th
+# percentile (p99) of the files' conversion cycles, then totalled per dialect as cycles per line and per byte.
+#
+# usage: bench/bench.sh [-a] [-c] [-f] [-s results.txt] [-b baseline.txt] file.prg...
+#   -a  use the 65C02 version of Lexer_Line() (lexer65.s) instead of the C one
+#   -c  read each program into a LineIndex first, and convert it in chunks (LineIndex_TextChunk()), instead of
+#       streaming it line by line. the cycles of the index run are subtracted instead of those of the read run
+#   -f  use PETSCII font mode
+#   -s  save the per-dialect results, to compare later runs with
+#   -b  compare with saved results, and flag any dialect more than 5% slower per byte
+#
+# needs cl65 and sim65 (cc65 2.19 or later) on the PATH. run it from the top of the source tree.
+
+CC65_TARGET=sim65c02
+BENCH_PRG=bench/bench.prg
+REGRESSION_PERCENT=5
+
+font=""
+lexer="lexer.c"
+read_mode="read"
+convert_mode="convert"
+save_file=""
+baseline_file=""
+
+while getopts "acfs:b:" opt; do
+	case $opt in
+		a) lexer="-DLEXER_ASM lexer.c lexer65.s" ;;
+		c) read_mode="index"; convert_mode="chunk" ;;
+		f) font="font" ;;
+		s) save_file=$OPTARG ;;
+		b) baseline_file=$OPTARG ;;
+		*) exit 1 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ]; then
+	echo "usage: $0 [-a] [-c] [-f] [-s results.txt] [-b baseline.txt] file.prg..."
+	exit 1
+fi
+
+# same optimization settings as the F256 build, so the cycles are those of the shipped code
+cl65 -t $CC65_TARGET -O -Or -Cl -o $BENCH_PRG bench/bench.c detokenize.c $lexer tokens.c select.c lineindex.c || exit 1
+
+# print the cycle count sim65 reports at exit, then the program's own output line
+run_bench()
+{
+	sim65 -c $BENCH_PRG "$1" "$2" $font | awk '/ cycles$/ { cycles = $1; next } { line = $0 } END { print cycles, line }'
+}
+
+results=$(mktemp)
+
+printf "%-16s %6s %7s %12s %10s %8s\n" "file" "lines" "bytes" "cycles" "cyc/line" "cyc/byte"
+
+for f in "$@"; do
+	set -- $(run_bench "$f" $read_mode)
+	read_cycles=$1
+	set -- $(run_bench "$f" $convert_mode)
+	convert_cycles=$1
+	lines=$2
+	bytes=$3
+	shift 3
+	dialect="$*"
+
+	if [ -z "$lines" ] || [ "$lines" -eq 0 ]; then
+		echo "$f: not a BASIC program, skipped"
+		continue
+	fi
+
+	cycles=$((convert_cycles - read_cycles))
+	printf "%-16s %6u %7u %12u %10u %8u\n" "$(basename "$f")" "$lines" "$bytes" "$cycles" $((cycles / lines)) $((cycles / bytes))
+	echo "$dialect|$lines|$bytes|$cycles" >> "$results"
+done
+
+# per file conversion cycles, nearest rank: p50 p99 max
+latency=$(cut -d'|' -f4 "$results" | sort -n | awk '{ c[NR] = $1 }
+	END { if (NR > 0) printf "%u %u %u", c[int((NR + 1) / 2)], c[int((NR * 99 + 99) / 100)], c[NR] }')
+
+if [ -n "$latency" ]; then
+	set -- $latency
+	echo
+	printf "cycles per file: p50 %u, p99 %u, max %u\n" $1 $2 $3
+fi
+
+# per dialect totals: dialect|cycles per line|cycles per byte
+totals=$(awk -F'|' '{ l[$1] += $2; b[$1] += $3; c[$1] += $4 }
+	END { for (d in l) printf "%s|%d|%d\n", d, c[d] / l[d], c[d] / b[d] }' "$results" | sort)
+rm -f "$results"
+
+echo
+printf "%-20s %10s %8s\n" "dialect" "cyc/line" "cyc/byte"
+echo "$totals" | awk -F'|' '{ printf "%-20s %10u %8u\n", $1, $2, $3 }'
+
+if [ -n "$save_file" ]; then
+	echo "$totals" > "$save_file"
+fi
+
+if [ -n "$baseline_file" ]; then
+	echo
+	echo "$totals" | awk -F'|' -v limit=$REGRESSION_PERCENT '
+		NR == FNR { base[$1] = $3; next }
+		($1 in base) && base[$1] > 0 {
+			change = ($3 - base[$1]) * 100 / base[$1]
+			printf "%-20s %+d%% cycles per byte%s\n", $1, change, (change > limit) ? "  <-- REGRESSION" : ""
+			if (change > limit) failed = 1
+		}
+		END { exit failed }' "$baseline_file" -
+fi
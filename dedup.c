@@ -0,0 +1,379 @@
+/*
+ * dedup.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+
+// project includes
+#include "dedup.h"
+
+// C includes
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// cc65 includes
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define DEDUP_HASH_SEED				5381	// djb2
+
+
+/*****************************************************************************/
+/*                          File-Scope Variables                             */
+/*****************************************************************************/
+
+// static because cc65 doesn't like creating that much on the stack.
+static uint8_t		dedup_line[256];						// line number + tokenized line + null
+static uint16_t		dedup_samples[DEDUP_MAX_SAMPLES];		// sampled line hashes of the program being added
+static uint8_t		dedup_shared[DEDUP_MAX_PROGRAMS];		// sampled lines each earlier program shares with it
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+// hash a line: its line number and tokenized body, not its link
+uint16_t Dedup_LineHash(uint8_t the_len);
+
+// hash a line hash to a bucket of the inverted index. the low bits are left out, as they are 0 in every sample.
+uint8_t Dedup_Bucket(uint16_t the_line_hash);
+
+// read a program file one line at a time, hashing each line, and keeping a sample of the line hashes
+// returns false if the file could not be read, or is not a BASIC program
+bool Dedup_ReadProgram(char* the_filename, uint32_t* the_hash, uint16_t* the_lines, uint8_t* the_num_samples, uint16_t* the_start);
+
+// find the earlier program that shares the most sampled lines with the one just read
+// returns the percentage of sampled lines in common, and the program in the_match
+uint8_t Dedup_FindNear(Dedup* the_dedup, uint8_t the_num_samples, DedupMatch* the_match);
+
+// add the sampled line hashes of a program to the inverted index
+void Dedup_Index(Dedup* the_dedup, uint8_t the_program, uint8_t the_num_samples);
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+
+// hash a line: its line number and tokenized body, not its link
+uint16_t Dedup_LineHash(uint8_t the_len)
+{
+	uint16_t	the_hash = DEDUP_HASH_SEED;
+	uint8_t		i;
+
+	for (i = 0; i < the_len; i++)
+	{
+		the_hash = ((the_hash << 5) + the_hash) ^ dedup_line[i];
+	}
+
+	return the_hash;
+}
+
+
+// hash a line hash to a bucket of the inverted index. the low bits are left out, as they are 0 in every sample.
+uint8_t Dedup_Bucket(uint16_t the_line_hash)
+{
+	return ((the_line_hash >> 2) ^ (the_line_hash >> 10)) & (DEDUP_HASH_SIZE - 1);
+}
+
+
+// read a program file one line at a time, hashing each line, and keeping a sample of the line hashes
+// returns false if the file could not be read, or is not a BASIC program
+bool Dedup_ReadProgram(char* the_filename, uint32_t* the_hash, uint16_t* the_lines, uint8_t* the_num_samples, uint16_t* the_start)
+{
+	FILE*		the_file;
+	uint16_t	cbm_addr;
+	uint16_t	nextadr;
+	int16_t		addr_lo;
+	int16_t		addr_hi;
+	uint8_t		the_len;
+	uint16_t	the_line_hash;
+	bool		the_result = false;
+
+	*the_hash = DEDUP_HASH_SEED;
+	*the_lines = 0;
+	*the_num_samples = 0;
+
+	the_file = fopen(the_filename, "r");
+
+	if (the_file == NULL)
+	{
+		return false;
+	}
+
+	addr_lo = fgetc(the_file);
+	addr_hi = fgetc(the_file);
+	cbm_addr = addr_lo + (addr_hi << 8);
+	*the_start = cbm_addr;
+
+	while (addr_lo >= 0 && addr_hi >= 0)
+	{
+		addr_lo = fgetc(the_file);
+		addr_hi = fgetc(the_file);
+
+		if (addr_lo < 0 || addr_hi < 0)
+		{
+			break;
+		}
+
+		nextadr = addr_lo + (addr_hi << 8);
+
+		if (nextadr == 0)
+		{
+			// end of program
+			the_result = (*the_lines > 0);
+			break;
+		}
+
+		// same checks as the converter: links go up, and a line is less than 256 bytes
+		if (nextadr <= cbm_addr || nextadr - cbm_addr >= 256 || nextadr - cbm_addr < 5)
+		{
+			break;
+		}
+
+		the_len = nextadr - cbm_addr - 2;
+
+		if (fread(dedup_line, 1, the_len, the_file) != the_len)
+		{
+			break;
+		}
+
+		cbm_addr = nextadr;
+		++(*the_lines);
+
+		the_line_hash = Dedup_LineHash(the_len);
+		*the_hash = ((*the_hash << 5) + *the_hash) ^ the_line_hash;
+
+		// LOGIC:
+		//   sampling by hash value, not by position, picks the same lines in every copy of a program, even if lines
+		//   were added or removed before them.
+		if ((the_line_hash & DEDUP_SAMPLE_MASK) == 0 && *the_num_samples < DEDUP_MAX_SAMPLES)
+		{
+			dedup_samples[(*the_num_samples)++] = the_line_hash;
+		}
+	}
+
+	fclose(the_file);
+
+	return the_result;
+}
+
+
+// find the earlier program that shares the most sampled lines with the one just read
+// returns the percentage of sampled lines in common, and the program in the_match
+uint8_t Dedup_FindNear(Dedup* the_dedup, uint8_t the_num_samples, DedupMatch* the_match)
+{
+	DedupPosting*	the_posting;
+	DedupProgram*	the_program;
+	uint8_t			i;
+	uint8_t			the_most;
+	uint8_t			the_percent;
+
+	the_match->program_ = DEDUP_NO_PROGRAM;
+	the_match->percent_ = 0;
+
+	memset(dedup_shared, 0, sizeof(dedup_shared));
+
+	// only programs that share a sampled line are ever looked at
+	for (i = 0; i < the_num_samples; i++)
+	{
+		for (the_posting = the_dedup->buckets_[Dedup_Bucket(dedup_samples[i])]; the_posting != NULL; the_posting = the_posting->next_)
+		{
+			if (the_posting->line_hash_ == dedup_samples[i])
+			{
+				++dedup_shared[the_posting->program_];
+			}
+		}
+	}
+
+	for (i = 0; i < the_dedup->num_programs_; i++)
+	{
+		if (dedup_shared[i] == 0)
+		{
+			continue;
+		}
+
+		// compared with the larger sample, so a short program isn't a near duplicate of a long one that contains it
+		the_program = &the_dedup->programs_[i];
+		the_most = (the_program->samples_ > the_num_samples) ? the_program->samples_ : the_num_samples;
+		the_percent = ((uint16_t)dedup_shared[i] * 100) / the_most;
+
+		if (the_percent > the_match->percent_)
+		{
+			the_match->program_ = i;
+			the_match->percent_ = the_percent;
+		}
+	}
+
+	return the_match->percent_;
+}
+
+
+// add the sampled line hashes of a program to the inverted index
+void Dedup_Index(Dedup* the_dedup, uint8_t the_program, uint8_t the_num_samples)
+{
+	DedupPosting*	the_posting;
+	uint8_t			i;
+	uint8_t			the_bucket;
+
+	for (i = 0; i < the_num_samples; i++)
+	{
+		the_posting = (DedupPosting*)malloc(sizeof(DedupPosting));
+
+		if (the_posting == NULL)
+		{
+			the_dedup->out_of_memory_ = true;
+			break;
+		}
+
+		the_bucket = Dedup_Bucket(dedup_samples[i]);
+		the_posting->line_hash_ = dedup_samples[i];
+		the_posting->program_ = the_program;
+		the_posting->next_ = the_dedup->buckets_[the_bucket];
+		the_dedup->buckets_[the_bucket] = the_posting;
+	}
+
+	the_dedup->programs_[the_program].samples_ = i;
+}
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+//! Create an empty set of fingerprints
+//! @return	Returns a pointer to the new Dedup, or NULL if it could not be allocated
+Dedup* Dedup_New(void)
+{
+	return (Dedup*)calloc(1, sizeof(Dedup));
+}
+
+
+//! Free a set of fingerprints and its index
+//! @param	the_dedup: pointer to the pointer to the Dedup. It is set to NULL.
+void Dedup_Destroy(Dedup** the_dedup)
+{
+	DedupPosting*	the_posting;
+	DedupPosting*	the_next;
+	uint8_t			i;
+
+	if (*the_dedup == NULL)
+	{
+		return;
+	}
+
+	for (i = 0; i < DEDUP_HASH_SIZE; i++)
+	{
+		for (the_posting = (*the_dedup)->buckets_[i]; the_posting != NULL; the_posting = the_next)
+		{
+			the_next = the_posting->next_;
+			free(the_posting);
+		}
+	}
+
+	free(*the_dedup);
+	*the_dedup = NULL;
+}
+
+
+//! Fingerprint a program file, and find the program seen before that it is most like
+//! The program is added to the set, in the cluster of the program it matched, or in a new cluster of its own.
+//! @param	the_dedup: valid pointer to a Dedup
+//! @param	the_filename: name of the program file
+//! @param	the_match: the program matched, and how closely, are returned here
+//! @return	Returns DEDUP_NEW, DEDUP_EXACT, DEDUP_NEAR, or DEDUP_ERROR
+uint8_t Dedup_AddFile(Dedup* the_dedup, char* the_filename, DedupMatch* the_match)
+{
+	DedupProgram*	the_program;
+	uint32_t		the_hash;
+	uint16_t		the_lines;
+	uint16_t		the_start;
+	uint8_t			the_num_samples;
+	uint8_t			the_index = the_dedup->num_programs_;
+	uint8_t			the_status = DEDUP_NEW;
+	uint8_t			i;
+
+	the_match->program_ = DEDUP_NO_PROGRAM;
+	the_match->percent_ = 0;
+
+	if (the_index == DEDUP_MAX_PROGRAMS || Dedup_ReadProgram(the_filename, &the_hash, &the_lines, &the_num_samples, &the_start) == false)
+	{
+		return DEDUP_ERROR;
+	}
+
+	// exact duplicates are found from the whole-program hash alone
+	for (i = 0; i < the_index; i++)
+	{
+		if (the_dedup->programs_[i].hash_ == the_hash && the_dedup->programs_[i].lines_ == the_lines)
+		{
+			the_match->program_ = i;
+			the_match->percent_ = 100;
+			the_status = DEDUP_EXACT;
+			break;
+		}
+	}
+
+	if (the_status == DEDUP_NEW && Dedup_FindNear(the_dedup, the_num_samples, the_match) >= DEDUP_NEAR_PERCENT)
+	{
+		the_status = DEDUP_NEAR;
+	}
+
+	the_program = &the_dedup->programs_[the_index];
+	strncpy(the_program->name_, the_filename, DEDUP_MAX_NAME_LEN);
+	the_program->name_[DEDUP_MAX_NAME_LEN] = '\0';
+	the_program->hash_ = the_hash;
+	the_program->lines_ = the_lines;
+	the_program->samples_ = 0;
+
+	if (the_status == DEDUP_NEW)
+	{
+		the_program->representative_ = the_index;
+		++the_dedup->num_clusters_;
+	}
+	else
+	{
+		the_program->representative_ = the_dedup->programs_[the_match->program_].representative_;
+	}
+
+	// an exact copy adds nothing to the index that its original didn't
+	if (the_status != DEDUP_EXACT)
+	{
+		Dedup_Index(the_dedup, the_index, the_num_samples);
+	}
+
+	++the_dedup->num_programs_;
+
+	if (the_status == DEDUP_NEW)
+	{
+		the_match->program_ = DEDUP_NO_PROGRAM;
+		the_match->percent_ = 0;
+	}
+
+	return the_status;
+}
+
+
+//! Get the content address of a program file: the whole-program hash used to find exact duplicates, its number of
+//! lines, and its start address. Programs with the same three convert to the same text.
+//! @param	the_filename: name of the program file
+//! @return	Returns false if the file could not be read, or is not a whole BASIC program (e.g. it is still being written)
+bool Dedup_HashFile(char* the_filename, uint32_t* the_hash, uint16_t* the_lines, uint16_t* the_start)
+{
+	uint8_t		the_num_samples;
+
+	return Dedup_ReadProgram(the_filename, the_hash, the_lines, &the_num_samples, the_start);
+}
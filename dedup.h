@@ -0,0 +1,122 @@
+/*
+ * dedup.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+#ifndef DEDUP_H
+#define DEDUP_H
+
+/* about this module: Dedup
+ *
+ * Finds programs that are copies of ones already seen, so only one of each needs converting.
+ *
+ * Each program is fingerprinted one line at a time: a hash of each line's number and tokenized body (the line links
+ * are left out, so a copy saved from another start address still matches), and a hash of the whole program built from
+ * those. Programs with the same whole-program hash and line count are exact duplicates, whatever their filenames.
+ *
+ * For near duplicates, such as a copy with a changed title line, a sample of each program's line hashes (about 1 in 4,
+ * chosen by the hash value, so the same lines are picked in every copy) is kept in an inverted index: line hash to
+ * the programs that have it. A new program is compared with only the programs that share at least one sampled line.
+ * If enough of its sampled lines are shared with one of them, it joins that program's cluster.
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+
+// C includes
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define DEDUP_MAX_PROGRAMS			64		// programs that can be fingerprinted in one pass
+#define DEDUP_MAX_SAMPLES			64		// sampled line hashes kept per program
+#define DEDUP_SAMPLE_MASK			0x03	// a line hash is sampled if these bits are all 0: about 1 line in 4
+#define DEDUP_HASH_SIZE				64		// buckets in the inverted index. must be a power of 2
+#define DEDUP_NEAR_PERCENT			75		// share of sampled lines two programs must have in common to be near duplicates
+#define DEDUP_MAX_NAME_LEN			16		// CBM DOS defined
+
+#define DEDUP_NO_PROGRAM			0xFF
+
+// results of adding a program
+#define DEDUP_NEW					0		// not like any program seen before
+#define DEDUP_EXACT					1		// the same as a program seen before
+#define DEDUP_NEAR					2		// most of its lines are the same as a program seen before
+#define DEDUP_ERROR					3		// could not be read, is not a BASIC program, or there is no room for more programs
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct DedupProgram
+{
+	char				name_[DEDUP_MAX_NAME_LEN + 1];
+	uint32_t			hash_;				// hash of all the line hashes, in order
+	uint16_t			lines_;
+	uint8_t				samples_;			// line hashes of this program in the index
+	uint8_t				representative_;	// first program of its cluster; its own index if it starts one
+} DedupProgram;
+
+typedef struct DedupPosting
+{
+	uint16_t			line_hash_;
+	uint8_t				program_;
+	struct DedupPosting*	next_;			// next posting in the same bucket
+} DedupPosting;
+
+typedef struct Dedup
+{
+	DedupProgram		programs_[DEDUP_MAX_PROGRAMS];
+	DedupPosting*		buckets_[DEDUP_HASH_SIZE];
+	uint8_t				num_programs_;
+	uint8_t				num_clusters_;
+	bool				out_of_memory_;		// true if some samples could not be indexed
+} Dedup;
+
+// what a new program was found to be like
+typedef struct DedupMatch
+{
+	uint8_t				program_;			// index of the program it matched, or DEDUP_NO_PROGRAM
+	uint8_t				percent_;			// share of sampled lines in common with it (100 for exact duplicates)
+} DedupMatch;
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                          */
+/*****************************************************************************/
+
+//! Create an empty set of fingerprints
+//! @return	Returns a pointer to the new Dedup, or NULL if it could not be allocated
+Dedup* Dedup_New(void);
+
+//! Free a set of fingerprints and its index
+//! @param	the_dedup: pointer to the pointer to the Dedup. It is set to NULL.
+void Dedup_Destroy(Dedup** the_dedup);
+
+//! Fingerprint a program file, and find the program seen before that it is most like
+//! The program is added to the set, in the cluster of the program it matched, or in a new cluster of its own.
+//! @param	the_dedup: valid pointer to a Dedup
+//! @param	the_filename: name of the program file
+//! @param	the_match: the program matched, and how closely, are returned here
+//! @return	Returns DEDUP_NEW, DEDUP_EXACT, DEDUP_NEAR, or DEDUP_ERROR
+uint8_t Dedup_AddFile(Dedup* the_dedup, char* the_filename, DedupMatch* the_match);
+
+//! Get the content address of a program file: the whole-program hash used to find exact duplicates, its number of
+//! lines, and its start address. Programs with the same three convert to the same text.
+//! @param	the_filename: name of the program file
+//! @return	Returns false if the file could not be read, or is not a whole BASIC program (e.g. it is still being written)
+bool Dedup_HashFile(char* the_filename, uint32_t* the_hash, uint16_t* the_lines, uint16_t* the_start);
+
+
+#endif /* DEDUP_H */
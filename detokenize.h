@@ -1,12 +1,33 @@
 #ifndef DETOKENIZE_H
 #define DETOKENIZE_H
 
+#include <stdint.h>
+
 
 /* BASIC mode selected */
 typedef enum basic_e {
 	Any, Basic2, Graphics52, TFC3, Basic7, Basic71, Basic35, Basic4, VicSuper
 } basic_t;
 
-int detokenize(const char *input_p, char *output_p, basic_t mode);
+/* Dialects compiled in. All of them are, unless the build leaves some
+ * out to make the program smaller: -DBASIC2_ONLY, or any of -DNO_GRAPHICS52,
+ * -DNO_TFC3, -DNO_BASIC7 (BASIC 7.0 and 7.1). BASIC 2.0 is always in.
+ * A program in a dialect left out is read as BASIC 2.0.
+ * BASIC 4.0 and VIC Super Expander have token tables, but nothing decodes
+ * them yet, so their tables are only compiled in with -DWITH_BASIC4 and
+ * -DWITH_VICSUPER.
+ */
+#ifdef BASIC2_ONLY
+	#define NO_GRAPHICS52
+	#define NO_TFC3
+	#define NO_BASIC7
+#endif
+
+/* detokenize option flags */
+#define DETOKENIZE_FLAG_NONE			0x00
+#define DETOKENIZE_FLAG_PETSCII_FONT	0x01	/* quoted PETSCII written as single PETSCII font codes, not {escapes} */
+#define DETOKENIZE_FLAG_SUPERBASIC		0x02	/* inconvert writes F256 SuperBASIC source instead of a listing (see superbasic.h) */
+
+int detokenize(const char *input_p, char *output_p, basic_t mode, uint8_t flags);
 
 #endif /* DETOKENIZE_H */
@@ -0,0 +1,169 @@
+/*
+ * extmem.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+
+// project includes
+#include "extmem.h"
+#include "lk_sys.h"
+
+// C includes
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+// cc65 includes
+
+
+/*****************************************************************************/
+/*                          File-Scope Variables                             */
+/*****************************************************************************/
+
+static uint16_t		extmem_len;
+static uint8_t		extmem_mapped_bank = EXTMEM_NO_BANK;	// program bank in the window now, or EXTMEM_NO_BANK
+static uint8_t		extmem_saved_bank;						// bank the window slot had before it was first mapped
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+// map a bank of the program (0 = its first 8K) into the window
+void ExtMem_MapBank(uint8_t the_bank);
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+
+// map a bank of the program (0 = its first 8K) into the window
+void ExtMem_MapBank(uint8_t the_bank)
+{
+	uint8_t		the_old_bank;
+
+	if (the_bank == extmem_mapped_bank)
+	{
+		return;
+	}
+
+	the_old_bank = Sys_MapBank(EXTMEM_WINDOW_SLOT, EXTMEM_FIRST_BANK + the_bank);
+
+	if (extmem_mapped_bank == EXTMEM_NO_BANK)
+	{
+		extmem_saved_bank = the_old_bank;
+	}
+
+	extmem_mapped_bank = the_bank;
+}
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+// **** Load functions *****
+
+//! Read the rest of a file into extended RAM, replacing any program that was there
+//! @param	in_file: open file, positioned just after the 2-byte start address
+//! @param	max_len: the most bytes to read
+//! @return	Returns the number of bytes read
+uint16_t ExtMem_Load(FILE* in_file, uint16_t max_len)
+{
+	uint8_t		the_bank = 0;
+	uint16_t	the_chunk;
+	uint16_t	bytes_read;
+
+	// LOGIC:
+	//   the file is read straight into the window, one whole bank at a time, so it never passes through the 64K
+
+	extmem_len = 0;
+
+	do
+	{
+		the_chunk = max_len - extmem_len;
+
+		if (the_chunk > EXTMEM_BANK_SIZE)
+		{
+			the_chunk = EXTMEM_BANK_SIZE;
+		}
+
+		ExtMem_MapBank(the_bank++);
+		bytes_read = fread(EXTMEM_WINDOW, 1, the_chunk, in_file);
+		extmem_len += bytes_read;
+	} while (bytes_read == EXTMEM_BANK_SIZE && extmem_len < max_len && the_bank < EXTMEM_NUM_BANKS);
+
+	ExtMem_Unmap();
+
+	return extmem_len;
+}
+
+
+//! Get the number of bytes of the program in extended RAM
+uint16_t ExtMem_Length(void)
+{
+	return extmem_len;
+}
+
+
+// **** Access functions *****
+
+//! Map the bank holding a program offset into the window
+//! @param	the_offset: offset in the program, below ExtMem_Length()
+//! @return	Returns the CPU address of the byte. The rest of its 8K bank follows it; the next bank does not.
+uint8_t* ExtMem_Map(uint16_t the_offset)
+{
+	ExtMem_MapBank(the_offset >> EXTMEM_BANK_SHIFT);
+
+	return EXTMEM_WINDOW + (the_offset & (EXTMEM_BANK_SIZE - 1));
+}
+
+
+//! Give the window slot back the bank it had before ExtMem_Map() or ExtMem_Load()
+void ExtMem_Unmap(void)
+{
+	if (extmem_mapped_bank == EXTMEM_NO_BANK)
+	{
+		return;
+	}
+
+	Sys_MapBank(EXTMEM_WINDOW_SLOT, extmem_saved_bank);
+	extmem_mapped_bank = EXTMEM_NO_BANK;
+}
+
+
+//! Copy bytes of the program out of extended RAM, across banks if need be. The window is unmapped afterwards.
+//! @param	the_dest: where to copy to. It must not be in the window.
+//! @param	the_offset: offset in the program of the first byte
+//! @param	the_len: number of bytes to copy
+void ExtMem_Copy(uint8_t* the_dest, uint16_t the_offset, uint16_t the_len)
+{
+	uint16_t	the_chunk;
+
+	while (the_len > 0)
+	{
+		// bytes left in this bank
+		the_chunk = EXTMEM_BANK_SIZE - (the_offset & (EXTMEM_BANK_SIZE - 1));
+
+		if (the_chunk > the_len)
+		{
+			the_chunk = the_len;
+		}
+
+		memcpy(the_dest, ExtMem_Map(the_offset), the_chunk);
+		the_dest += the_chunk;
+		the_offset += the_chunk;
+		the_len -= the_chunk;
+	}
+
+	ExtMem_Unmap();
+}
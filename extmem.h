@@ -0,0 +1,82 @@
+/*
+ * extmem.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+#ifndef EXTMEM_H
+#define EXTMEM_H
+
+/* about this module: ExtMem
+ *
+ * Holds one whole BASIC program in the F256's RAM above the CPU's own 64K, so it can be read from disk once and
+ * then gone over as many times as needed (line index, search, preview) without taking any of the 64K.
+ * The program is kept in consecutive 8K banks, and the bank holding a given offset is mapped into one CPU slot
+ * (the window) when it is needed. Only used when built with EXTMEM defined: see LineIndex.
+ *
+ * The window slot must not hold any of the program's own code, data, stack or heap. Pointers returned by
+ * ExtMem_Map() are only good until the next ExtMem call.
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+
+// C includes
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define EXTMEM_WINDOW_SLOT			5		// CPU slot banks are mapped into: A000-BFFF, the same one lk_sys.c uses as overlay
+#define EXTMEM_WINDOW				((uint8_t*)0xA000)
+#define EXTMEM_BANK_SIZE			0x2000
+#define EXTMEM_BANK_SHIFT			13
+#define EXTMEM_FIRST_BANK			8		// physical bank the program starts in: the first one above the CPU's 64K
+#define EXTMEM_NUM_BANKS			8		// 64K: no CBM program can be bigger
+#define EXTMEM_NO_BANK				0xFF
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                          */
+/*****************************************************************************/
+
+// **** Load functions *****
+
+//! Read the rest of a file into extended RAM, replacing any program that was there
+//! @param	in_file: open file, positioned just after the 2-byte start address
+//! @param	max_len: the most bytes to read
+//! @return	Returns the number of bytes read
+uint16_t ExtMem_Load(FILE* in_file, uint16_t max_len);
+
+//! Get the number of bytes of the program in extended RAM
+uint16_t ExtMem_Length(void);
+
+
+// **** Access functions *****
+
+//! Map the bank holding a program offset into the window
+//! @param	the_offset: offset in the program, below ExtMem_Length()
+//! @return	Returns the CPU address of the byte. The rest of its 8K bank follows it; the next bank does not.
+uint8_t* ExtMem_Map(uint16_t the_offset);
+
+//! Give the window slot back the bank it had before ExtMem_Map() or ExtMem_Load()
+void ExtMem_Unmap(void);
+
+//! Copy bytes of the program out of extended RAM, across banks if need be. The window is unmapped afterwards.
+//! @param	the_dest: where to copy to. It must not be in the window.
+//! @param	the_offset: offset in the program of the first byte
+//! @param	the_len: number of bytes to copy
+void ExtMem_Copy(uint8_t* the_dest, uint16_t the_offset, uint16_t the_len);
+
+
+#endif /* EXTMEM_H */
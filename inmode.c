@@ -9,39 +9,177 @@
 #include <stdlib.h>
 #include "inmode.h"
 #include "detokenize.h"
+#include "lexer.h"
 #include "select.h"
+#include "superbasic.h"
+#include "profile.h"
 
 #include "basic2text.h"
 
+/* The program is read, and the text written, in blocks rather than a
+ * line at a time: each fgetc/fread/fwrite that reaches the kernel costs
+ * far more than copying the bytes, so this keeps the CPU converting
+ * instead of waiting on the drive between lines.
+ */
+#define INCONVERT_READ_SIZE		1024	/* bytes of program read at a time */
+#define INCONVERT_WRITE_SIZE	1024	/* bytes of text written at a time */
+
 // made next 2 static because cc65 doesn't like creating that much on the stack.
 static char buf[256];
 static char text[512];
+static LexerLine line;
+
+static unsigned char in_block[INCONVERT_READ_SIZE];
+static uint16_t in_pos;				/* next byte of in_block to hand out */
+static uint16_t in_len;				/* bytes in in_block */
+static char out_block[INCONVERT_WRITE_SIZE];
+static uint16_t out_len;			/* bytes waiting in out_block */
+
+
+/* inread
+ * - reads bytes of the program through the read block
+ * in:	in_file - open file
+ *		dest_p - where to copy the bytes, or NULL to return just one
+ *		len - number of bytes
+ * out:	the byte if dest_p is NULL, otherwise 0; -1 if the file ended first
+ */
+static int16_t inread(FILE* in_file, char* dest_p, uint16_t len)
+{
+	uint16_t	chunk;				/* bytes taken from the block at once */
+
+	do {
+		if (in_pos == in_len) {
+			in_len = fread(in_block, 1, INCONVERT_READ_SIZE, in_file);
+			in_pos = 0;
+			PROFILE_COUNT(block_reads_);
+
+			if (0 == in_len) {
+				return -1;
+			} /* if */
+		} /* if */
+
+		if (NULL == dest_p) {
+			return in_block[in_pos++];
+		} /* if */
+
+		chunk = in_len - in_pos;
+		if (chunk > len) {
+			chunk = len;
+		} /* if */
+
+		memcpy(dest_p, in_block + in_pos, chunk);
+		in_pos += chunk;
+		dest_p += chunk;
+		len -= chunk;
+	} while (len > 0);
+
+	return 0;
+}
+
+
+/* outflush
+ * - writes out the text waiting in the write block
+ * in:	out_file - open file
+ * out:	none
+ */
+static void outflush(FILE* out_file)
+{
+	if (out_len > 0) {
+		fwrite(out_block, 1, out_len, out_file);
+		out_len = 0;
+		PROFILE_COUNT(block_writes_);
+	} /* if */
+}
+
+
+/* outwrite
+ * - writes text through the write block
+ * in:	out_file - open file
+ *		text_p - text to write
+ *		len - number of bytes (never more than INCONVERT_WRITE_SIZE)
+ * out:	none
+ */
+static void outwrite(FILE* out_file, const char* text_p, uint16_t len)
+{
+	if (out_len + len > INCONVERT_WRITE_SIZE) {
+		outflush(out_file);
+	} /* if */
+
+	memcpy(out_block + out_len, text_p, len);
+	out_len += len;
+}
 
 
 /* inconvert
  * - performs the actual conversion
  * in:	input - open file, positioned at start of BASIC program
  * 		output - open file, to write to
- * out:	none
+ *		cbm_addr - start address of the program
+ *		mode - BASIC dialect of the program (see detectbasic)
+ *		flags - DETOKENIZE_FLAG_xxx options passed on to detokenize
+ *		the_stats - conversion statistics are returned here
+ *		the_xref - cross-reference to record line targets and variables in, or NULL
+ * out:	ERROR_NO_ERROR, or the ERROR_xxx code of what was wrong with the
+ *		program. Either way, the lines converted are written and the files
+ *		are left open for the caller to close.
  */
-void inconvert(FILE* in_file, FILE* out_file, int16_t cbm_addr)
+uint8_t inconvert(FILE* in_file, FILE* out_file, int16_t cbm_addr, basic_t mode, uint8_t flags, ConvertStats* the_stats, Xref* the_xref)
 {
+	uint8_t		error_code = ERROR_NO_ERROR;
 	int16_t		expected_len;
 // 	int16_t		actual_len;
-	int16_t		detokenized_len;
+	LexerText	text_out;
+	SuperBasicText	superbasic_out;
+	uint16_t*	text_len_p = &text_out.len_;
+	LexerOutput	outputs[3];
+	uint8_t		num_outputs = 2;
 	int16_t		nextadr;
 	int16_t		addr_lo;
 	int16_t		addr_hi;
-	basic_t		mode;
+
+	the_stats->bytes_in_ = 2;	// start address was read by the caller
+	the_stats->bytes_out_ = 0;
+	the_stats->lines_ = 0;
+	the_stats->rem_lines_ = 0;
+	memset(&the_stats->lexer_stats_, 0, sizeof(LexerStats));
+	
+	/* Each line is decoded once, then written as text and counted */
+	text_out.buffer_ = text;
+	text_out.flags_ = flags;
+	outputs[0].back_end_ = Lexer_TextBackEnd;
+	outputs[0].context_ = &text_out;
+	
+	/* SuperBASIC source is written from the same decoded line, by another back-end */
+	if (flags & DETOKENIZE_FLAG_SUPERBASIC)
+	{
+		superbasic_out.buffer_ = text;
+		superbasic_out.rem_lines_ = 0;
+		outputs[0].back_end_ = SuperBasic_BackEnd;
+		outputs[0].context_ = &superbasic_out;
+		text_len_p = &superbasic_out.len_;
+	}
+	
+	outputs[1].back_end_ = Lexer_StatsBackEnd;
+	outputs[1].context_ = &the_stats->lexer_stats_;
+	
+	if (the_xref != NULL)
+	{
+		outputs[2].back_end_ = Xref_BackEnd;
+		outputs[2].context_ = the_xref;
+		++num_outputs;
+	}
+	
+	in_pos = in_len = 0;
+	out_len = 0;
+
+	the_stats->ticks_ = clock();
+	PROFILE_RESET();
+	PROFILE_START();
 
 	/* Check for valid BASIC file */
 	if (cbm_addr == 0x0401 || cbm_addr == 0x0801 || cbm_addr == 0x1c01 ||
 	    cbm_addr == 0x4001 || cbm_addr == 0x132D) 
 	{
-		mode = selectbasic(cbm_addr);
-
-		printf("mode=%u \n", mode);
-
 		/* If this is a combined BASIC 7.1 extension + BASIC text,
 		 * skip over the header (0x132D - 0x1C00)
 		 */
@@ -62,28 +200,21 @@ void inconvert(FILE* in_file, FILE* out_file, int16_t cbm_addr)
 		/* Read address to next line */
 // 		nextadr = fgetc(in_file); // low byte
 // 		nextadr |= fgetc(in_file) << 8; // high byte
-		addr_lo = fgetc(in_file); // low byte
+		addr_lo = inread(in_file, NULL, 1); // low byte
 
 		if (addr_lo < 0)
 		{
 			printf("Error getting 1st byte of next line address \n");
-			exit_with_wait(ERROR_UNABLE_TO_OPEN_OUTPUT_FILE);
+			error_code = ERROR_UNABLE_TO_OPEN_OUTPUT_FILE;
 		}
-	
-		addr_hi = fgetc(in_file); // low byte
-
-		if (addr_hi < 0)
+		else if ((addr_hi = inread(in_file, NULL, 1)) < 0) // high byte
 		{
 			printf("Error getting 2nd byte of next line address \n");
-			exit_with_wait(ERROR_UNABLE_TO_OPEN_OUTPUT_FILE);
+			error_code = ERROR_UNABLE_TO_OPEN_OUTPUT_FILE;
 		}
-	
-		nextadr = addr_lo + (addr_hi << 8);
-
-		
-		if (nextadr < 0 || nextadr == 1)
+		else if ((nextadr = addr_lo + (addr_hi << 8)) < 0 || nextadr == 1)
 		{
-			exit_with_wait(ERROR_UNEXPECTED_FILE_DATA);
+			error_code = ERROR_UNEXPECTED_FILE_DATA;
 		}
 		else if (nextadr == 0)
 		{
@@ -98,36 +229,60 @@ void inconvert(FILE* in_file, FILE* out_file, int16_t cbm_addr)
 			while (nextadr && nextadr > cbm_addr && nextadr - cbm_addr < 256) {
 				expected_len = nextadr - cbm_addr - 2;
 			
-				/* Read the line into the buffer */
-				if (fread(buf, 1, expected_len, in_file) != expected_len)
+				/* Read the line into the buffer: a short read means the file was cut off */
+				if (inread(in_file, buf, expected_len) < 0)
 				{
-					exit_with_wait(0);
+					break;
 				}
  
  				cbm_addr = nextadr;
 
+				PROFILE_LAP(PROFILE_PHASE_READ);
+
 				/* Convert to text */
-				detokenized_len = detokenize(buf, text, mode);
+				Lexer_Line(&line, buf, mode);
+				PROFILE_LAP(PROFILE_PHASE_DECODE);
+				Lexer_Emit(&line, outputs, num_outputs);
+				PROFILE_LAP(PROFILE_PHASE_EMIT);
 
 				/* Write to output */			
-				fwrite(text, 1, detokenized_len, out_file);
+				outwrite(out_file, text, *text_len_p);
+				PROFILE_LAP(PROFILE_PHASE_WRITE);
+
+				the_stats->bytes_in_ += expected_len + 2;
+				the_stats->bytes_out_ += *text_len_p;
+				++the_stats->lines_;
 				
 				// dump to screen
 				printf("%s", text);
+				PROFILE_LAP(PROFILE_PHASE_ECHO);
 				
 				/* Read address to next line */
-				addr_lo = fgetc(in_file); // low byte
-				addr_hi = fgetc(in_file); // low byte
+				addr_lo = inread(in_file, NULL, 1); // low byte
+				addr_hi = inread(in_file, NULL, 1); // low byte
 				nextadr = addr_lo + (addr_hi << 8);
 			}
 
-			/* If nextadr != null, then the program was invalid */
+			/* If nextadr != null, then the program was invalid or cut off */
 			if (nextadr != 0) {
-				exit_with_wait(ERROR_INVALID_BASIC_FILE);
+				error_code = ERROR_INVALID_BASIC_FILE;
+			}
+			else {
+				the_stats->bytes_in_ += 2;	// end of program marker
 			}
 		}	
+		
+		/* The lines converted so far are kept, even if the program turned out to be bad */
+		outflush(out_file);
+		PROFILE_LAP(PROFILE_PHASE_WRITE);
+		
+		the_stats->ticks_ = clock() - the_stats->ticks_;
+		the_stats->rem_lines_ = (flags & DETOKENIZE_FLAG_SUPERBASIC) ? superbasic_out.rem_lines_ : 0;
 	}
 	else {
-		exit_with_wait(ERROR_INVALID_BASIC_START_ADDRESS);
+		the_stats->ticks_ = clock() - the_stats->ticks_;
+		error_code = ERROR_INVALID_BASIC_START_ADDRESS;
 	}
+
+	return error_code;
 }
\ No newline at end of file
@@ -4,15 +4,37 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <time.h>
+#include "lexer.h"
+#include "xref.h"
+
+
+/* conversion statistics, filled in by inconvert */
+typedef struct ConvertStats
+{
+	uint32_t	bytes_in_;		/* tokenized bytes read, including link and line number bytes */
+	uint32_t	bytes_out_;		/* text bytes written */
+	uint16_t	lines_;			/* number of BASIC lines converted */
+	clock_t		ticks_;			/* time spent converting, in clock() ticks */
+	LexerStats	lexer_stats_;	/* keyword and character counts */
+	uint16_t	rem_lines_;		/* lines written as REMs, as they could not be translated to SuperBASIC */
+} ConvertStats;
 
 
 /* inconvert
  * - performs the actual conversion
  * in:	input - open file, positioned at start of BASIC program
  * 		output - open file, to write to
- * out:	none
+ *		cbm_addr - start address of the program
+ *		mode - BASIC dialect of the program (see detectbasic)
+ *		flags - DETOKENIZE_FLAG_xxx options passed on to detokenize
+ *		the_stats - conversion statistics are returned here
+ *		the_xref - cross-reference to record line targets and variables in, or NULL
+ * out:	ERROR_NO_ERROR, or the ERROR_xxx code of what was wrong with the
+ *		program. Either way, the lines converted are written and the files
+ *		are left open for the caller to close.
  */
-void inconvert(FILE* in_file, FILE* output_fd, int16_t cbm_addr);
+uint8_t inconvert(FILE* in_file, FILE* output_fd, int16_t cbm_addr, basic_t mode, uint8_t flags, ConvertStats* the_stats, Xref* the_xref);
 
 
 #endif /* INMODE_H */
@@ -0,0 +1,696 @@
+/*
+ * lexer.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+
+// project includes
+#include "lexer.h"
+#include "detokenize.h"
+#include "tokens.h"
+#include "profile.h"
+
+// C includes
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// cc65 includes
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define CH_QUOTE					34
+#define TOKEN_PREFIX_CE				0xCE
+#define TOKEN_PREFIX_FE				0xFE
+
+#define LEXER_ITEM_TEXT_MAX			256		// longest text one item can produce: a run of 255 single characters
+#define LEXER_NUM_DIALECTS			(VicSuper + 1)
+
+// keyword limits of the extension dialects. a dialect left out of the build (see detokenize.h) has none.
+#ifndef NO_GRAPHICS52
+	#define LEXER_GRAPHICS52_COUNT	GRAPHICS52TOKENS_COUNT
+#else
+	#define LEXER_GRAPHICS52_COUNT	0
+#endif
+
+#ifndef NO_TFC3
+	#define LEXER_TFC3_COUNT		TFC3TOKENS_COUNT
+#else
+	#define LEXER_TFC3_COUNT		0
+#endif
+
+#ifndef NO_BASIC7
+	#define LEXER_C128_COUNT		C128TOKENS_COUNT
+	#define LEXER_CE_END			C128CETOKENS_COUNT
+	#define LEXER_FE_END_BASIC7		0x27
+	#define LEXER_FE_END_BASIC71	0x38
+#else
+	#define LEXER_C128_COUNT		0
+	#define LEXER_CE_END			0
+	#define LEXER_FE_END_BASIC7		0
+	#define LEXER_FE_END_BASIC71	0
+#endif
+
+
+/*****************************************************************************/
+/*                          File-Scope Variables                             */
+/*****************************************************************************/
+
+// static because cc65 doesn't like creating that much on the stack.
+static char			lexer_item_text[LEXER_ITEM_TEXT_MAX];
+
+// keyword text of a token with no keyword in this build, packed
+static const unsigned char	lexer_no_keyword[1] = { TOKEN_END_BIT };
+
+// what each character below 128 outside quotes is written as, when it is written as itself: 32-64, [ and ] as they
+// are, and letters in lower case (keywords are the upper case text). 0 for those written as an {escape}.
+static const char	lexer_plain_char[128] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 0-15
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 16-31
+	' ', '!', '"', '#', '$', '%', '&', '\'', '(', ')', '*', '+', ',', '-', '.', '/',	// 32-47
+	'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', ':', ';', '<', '=', '>', '?',	// 48-63
+	'@', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o',	// 64-79
+	'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z', '[', 0, ']', 0, 0,	// 80-95
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 96-111
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 112-127
+};
+
+#ifdef TOKENS_FILE
+
+// per dialect, indexed by basic_t: the table the extension keywords are in, loaded with the rest of its set
+static const uint8_t	lexer_ext_table[LEXER_NUM_DIALECTS] =
+{
+	C64Tokens, C64Tokens, Graphics52Tokens, TFC3Tokens, C128Tokens, C128Tokens, C64Tokens, C64Tokens, C64Tokens
+};
+
+#endif
+
+static const char*	lexer_kind_names[LEXER_NUM_KINDS] =
+{
+	"char",
+	"keyword",
+	"keyword",
+	"keyword",
+	"bad",
+	"quote",
+	"string",
+};
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+// per dialect, indexed by basic_t: keywords 204 on, and the ends of the CE and FE prefixed ones. lexer65.s uses these
+// too. with TOKENS_FILE, a dialect whose tables can't be loaded has its entries set to 0 (see Lexer_LoadTables()).
+uint8_t		lexer_extension_count[LEXER_NUM_DIALECTS] =
+{
+	0, 0, LEXER_GRAPHICS52_COUNT, LEXER_TFC3_COUNT, LEXER_C128_COUNT, LEXER_C128_COUNT, 0, 0, 0
+};
+
+uint8_t		lexer_ce_end[LEXER_NUM_DIALECTS] =
+{
+	0, 0, 0, 0, LEXER_CE_END, LEXER_CE_END, 0, 0, 0
+};
+
+uint8_t		lexer_fe_end[LEXER_NUM_DIALECTS] =
+{
+	0, 0, 0, 0, LEXER_FE_END_BASIC7, LEXER_FE_END_BASIC71, 0, 0, 0
+};
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+#ifndef LEXER_ASM
+
+// work out what kind of keyword item the token byte at ch_p is, in this dialect. fills in kind_ and value_.
+// returns the number of bytes used (2 for CE/FE-prefixed tokens, otherwise 1)
+uint8_t Lexer_ClassifyToken(const unsigned char* ch_p, basic_t mode, LexerItem* the_item);
+
+#endif
+
+// add a span to the list, or extend the last one if it is the same kind and directly before it
+void Lexer_AddSpan(LexerSpans* the_spans, uint8_t the_kind, uint16_t the_column, uint16_t the_len);
+
+// the one character a PETSCII code in a string is named with, or 0 if its name is longer
+char Lexer_StringChar(uint8_t the_char);
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+
+#ifndef LEXER_ASM
+
+// work out what kind of keyword item the token byte at ch_p is, in this dialect. fills in kind_ and value_.
+// returns the number of bytes used (2 for CE/FE-prefixed tokens, otherwise 1)
+uint8_t Lexer_ClassifyToken(const unsigned char* ch_p, basic_t mode, LexerItem* the_item)
+{
+	uint8_t		the_ext = *ch_p - 204;
+
+	the_item->value_ = *ch_p;
+	the_item->kind_ = LEXER_KIND_KEYWORD;
+
+	if (*ch_p <= 203)
+	{
+		// C64 BASIC 2.0
+		PROFILE_COUNT(basic2_keywords_);
+		return 1;
+	}
+
+	if (*ch_p == TOKEN_PREFIX_CE && ch_p[1] >= 2 && ch_p[1] < lexer_ce_end[mode])
+	{
+		PROFILE_COUNT(ce_prefixes_);
+		the_item->kind_ = LEXER_KIND_KEYWORD_CE;
+		the_item->value_ = ch_p[1];
+		return 2;
+	}
+
+	if (*ch_p == TOKEN_PREFIX_FE && ch_p[1] >= 2 && ch_p[1] < lexer_fe_end[mode])
+	{
+		PROFILE_COUNT(fe_prefixes_);
+		the_item->kind_ = LEXER_KIND_KEYWORD_FE;
+		the_item->value_ = ch_p[1];
+		return 2;
+	}
+
+	// the extension tables are shorter than 204-254: anything past their end is not a keyword
+	if (the_ext < lexer_extension_count[mode])
+	{
+		PROFILE_COUNT(extension_keywords_);
+		return 1;
+	}
+
+	PROFILE_COUNT(bad_tokens_);
+	the_item->kind_ = LEXER_KIND_BAD_TOKEN;
+
+	return 1;
+}
+
+#endif
+
+
+// add a span to the list, or extend the last one if it is the same kind and directly before it
+void Lexer_AddSpan(LexerSpans* the_spans, uint8_t the_kind, uint16_t the_column, uint16_t the_len)
+{
+	LexerSpan*	the_span;
+
+	if (the_spans->num_spans_ > 0)
+	{
+		the_span = &the_spans->spans_[the_spans->num_spans_ - 1];
+
+		if (the_span->kind_ == the_kind && the_span->column_ + the_span->len_ == the_column)
+		{
+			the_span->len_ += the_len;
+			return;
+		}
+	}
+
+	if (the_spans->num_spans_ >= LEXER_MAX_ITEMS)
+	{
+		return;
+	}
+
+	the_span = &the_spans->spans_[the_spans->num_spans_++];
+	the_span->kind_ = the_kind;
+	the_span->column_ = the_column;
+	the_span->len_ = the_len;
+}
+
+
+// the one character a PETSCII code in a string is named with, or 0 if its name is longer
+char Lexer_StringChar(uint8_t the_char)
+{
+	// LOGIC:
+	//   the PETSCII names that are one character long are the ones lexer_plain_char[] has, ^, and shifted letters
+	//   (193-218, in upper case). none of them has a font code, so in font mode too they are written as this.
+
+	if (the_char < 128)
+	{
+		return (the_char == 94) ? '^' : lexer_plain_char[the_char];
+	}
+
+	if (the_char >= 193 && the_char <= 218)
+	{
+		return the_char - 128;
+	}
+
+	return 0;
+}
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+#ifdef TOKENS_FILE
+
+//! Make sure the keyword tables of a dialect are loaded (see tokens.h). If they can't be, the dialect's extension
+//! keywords are decoded as bad tokens from then on, and written as {nnn}, as for a dialect left out of the build.
+//! @param	mode: BASIC dialect about to be decoded
+void Lexer_LoadTables(basic_t mode)
+{
+	if (lexer_extension_count[mode] == 0 || tokenready(lexer_ext_table[mode]))
+	{
+		return;
+	}
+	
+	lexer_extension_count[mode] = 0;
+	lexer_ce_end[mode] = 0;
+	lexer_fe_end[mode] = 0;
+}
+
+#endif
+
+
+// LOGIC:
+//   with LEXER_ASM defined, Lexer_Line() comes from lexer65.s instead. this version stays the reference for it, and
+//   is the one used on other systems.
+
+#ifndef LEXER_ASM
+
+//! Decode a tokenized line into items
+//! @param	the_line: valid pointer to a LexerLine, which is overwritten
+//! @param	input_p: line number (2 bytes), followed by the tokenized line, null terminated
+//! @param	mode: BASIC dialect to decode tokens for
+void Lexer_Line(LexerLine* the_line, const char* input_p, basic_t mode)
+{
+	const unsigned char*	ch_p = (const unsigned char*)input_p + 2;
+	const unsigned char*	the_start = ch_p;
+	LexerItem*				the_item = the_line->items_;
+	LexerItem*				the_last_item = the_line->items_ + LEXER_MAX_ITEMS;
+	const unsigned char*	run_p;
+	bool					quotemode = false;
+	uint8_t					the_char;
+	uint8_t					the_run;
+
+#ifdef TOKENS_FILE
+	Lexer_LoadTables(mode);
+#endif
+
+	the_line->line_number_ = (unsigned char)input_p[0] | ((unsigned char)input_p[1] << 8);
+	the_line->mode_ = mode;
+	PROFILE_COUNT(lines_);
+
+	// LOGIC:
+	//   same rules as BasText's detokenize: outside quotes, 128-254 are tokens; inside quotes, everything but the
+	//   closing quote is PETSCII. identical characters in a string are collapsed into one item with a run count,
+	//   and back-ends decide how to show them.
+	//   a line can't have more items than LEXER_MAX_ITEMS, but decoding stops there anyway, in case a caller passes one
+	//   that is missing its terminator.
+
+	while (*ch_p && the_item < the_last_item)
+	{
+		the_item->offset_ = ch_p - the_start;
+		the_item->value_ = *ch_p;
+		the_item->run_ = 1;
+
+		if (*ch_p == CH_QUOTE)
+		{
+			the_item->kind_ = LEXER_KIND_QUOTE;
+			quotemode = !quotemode;
+			++ch_p;
+		}
+		else if (quotemode)
+		{
+			// the byte is kept in a local and the run walked with a pointer: cc65 would otherwise re-read *ch_p and
+			// add the_run to ch_p for every byte compared. neither the null nor a quote can match, so the run stops
+			// in the string.
+			the_item->kind_ = LEXER_KIND_STRING;
+			the_char = *ch_p;
+			run_p = ch_p + 1;
+
+			while (*run_p == the_char)
+			{
+				++run_p;
+			}
+
+			the_run = run_p - ch_p;
+			the_item->run_ = the_run;
+			ch_p = run_p;
+			
+#ifdef PROFILE
+			profile_counters.string_chars_ += the_run;
+			
+			if (the_run > 1)
+			{
+				PROFILE_COUNT(string_runs_);
+			}
+#endif
+		}
+		else if (*ch_p >= 128 && *ch_p <= 254)
+		{
+			ch_p += Lexer_ClassifyToken(ch_p, mode, the_item);
+		}
+		else
+		{
+			the_item->kind_ = LEXER_KIND_CHAR;
+			++ch_p;
+		}
+
+		++the_item;
+	}
+
+	the_line->num_items_ = the_item - the_line->items_;
+}
+
+#endif
+
+
+//! Run each of the passed back-ends on a decoded line
+//! @param	the_line: valid pointer to a decoded line
+//! @param	the_outputs: array of back-end + context pairs
+//! @param	num_outputs: number of entries in the_outputs
+void Lexer_Emit(LexerLine* the_line, LexerOutput* the_outputs, uint8_t num_outputs)
+{
+	while (num_outputs--)
+	{
+		(*the_outputs->back_end_)(the_line, the_outputs->context_);
+		++the_outputs;
+	}
+}
+
+
+//! Get the keyword text of a LEXER_KIND_KEYWORD, _KEYWORD_CE, or _KEYWORD_FE item
+//! @param	the_line: valid pointer to a decoded line (for its dialect)
+//! @param	the_item: valid pointer to a keyword item in the_line
+//! @return	Returns the keyword, in upper case, packed (see tokens.h)
+const unsigned char* Lexer_KeywordText(LexerLine* the_line, LexerItem* the_item)
+{
+	// LOGIC:
+	//   the lexer never makes an extension keyword item for a dialect left out of the build, so the tables that aren't
+	//   compiled in are never needed.
+
+	(void)the_line;
+
+#ifndef NO_BASIC7
+	if (the_item->kind_ == LEXER_KIND_KEYWORD_CE)
+	{
+		return tokentext(C128CETokens, the_item->value_);
+	}
+
+	if (the_item->kind_ == LEXER_KIND_KEYWORD_FE)
+	{
+		return tokentext(C128FETokens, the_item->value_);
+	}
+#endif
+
+	if (the_item->value_ <= 203)
+	{
+		return tokentext(C64Tokens, the_item->value_ - 128);
+	}
+
+#ifndef NO_BASIC7
+	if (Basic7 == the_line->mode_ || Basic71 == the_line->mode_)
+	{
+		return tokentext(C128Tokens, the_item->value_ - 204);
+	}
+#endif
+
+#ifndef NO_GRAPHICS52
+	if (Graphics52 == the_line->mode_)
+	{
+		return tokentext(Graphics52Tokens, the_item->value_ - 204);
+	}
+#endif
+
+#ifndef NO_TFC3
+	if (TFC3 == the_line->mode_)
+	{
+		return tokentext(TFC3Tokens, the_item->value_ - 204);
+	}
+#endif
+
+	return lexer_no_keyword;
+}
+
+
+//! Write the text of one item, as it appears in the text listing
+//! @param	the_line: valid pointer to a decoded line
+//! @param	the_item: valid pointer to an item in the_line
+//! @param	output_p: buffer to write to. It is not null terminated.
+//! @param	flags: DETOKENIZE_FLAG_xxx options
+//! @return	Returns the number of characters written
+uint16_t Lexer_ItemText(LexerLine* the_line, LexerItem* the_item, char* output_p, uint8_t flags)
+{
+	char*			the_start = output_p;
+	uint8_t			the_char = the_item->value_;
+	uint8_t			the_run = the_item->run_;
+	const unsigned char*	escape_p;
+	unsigned char	fontcode = 0;
+	char			the_plain;
+	bool			isspecial;
+
+	switch (the_item->kind_)
+	{
+		case LEXER_KIND_KEYWORD:
+		case LEXER_KIND_KEYWORD_CE:
+		case LEXER_KIND_KEYWORD_FE:
+			output_p += tokencopy(output_p, Lexer_KeywordText(the_line, the_item));
+			break;
+
+		case LEXER_KIND_BAD_TOKEN:
+			output_p += sprintf(output_p, "{%d}", the_char);
+			break;
+
+		case LEXER_KIND_QUOTE:
+			*(output_p++) = '\"';
+			break;
+
+		case LEXER_KIND_CHAR:
+			/* PETSCII text in BASIC:
+			 * The only possible case of text is unshifted. To increase
+			 * readability, this is written as lowercase ASCII, whereas
+			 * keywords are written as uppercase.
+			 * There can also be special characters (32-64), they are
+			 * printed as-is.
+			 */
+			if (the_char < 128 && lexer_plain_char[the_char])
+			{
+				*(output_p++) = lexer_plain_char[the_char];
+			}
+			else
+			{
+				*(output_p++) = '{';
+				output_p += tokencopy(output_p, tokentext(PetsciiNames, the_char));
+				*(output_p++) = '}';
+			}
+			break;
+
+		case LEXER_KIND_STRING:
+			// a character with a one-character name is never written as a repetition, except space, so it can be
+			// written without looking its name up. that includes *, as {**n} is not parsed correctly.
+			the_plain = Lexer_StringChar(the_char);
+
+			if (the_plain && (the_run == 1 || 32 != the_char))
+			{
+				while (the_run--)
+				{
+					*(output_p++) = the_plain;
+				}
+				break;
+			}
+
+			escape_p = tokentext(PetsciiNames, the_char);
+
+			// in PETSCII font mode, characters with a glyph in the font are written as a single byte,
+			// and only use the escape name if they repeat three or more times
+			if (flags & DETOKENIZE_FLAG_PETSCII_FONT)
+			{
+				fontcode = petscii_font[the_char];
+			}
+
+			isspecial = (!(escape_p[0] & TOKEN_END_BIT) && fontcode == 0);
+
+			// repetitions are written as {x*n} if there are 2 or more of a special character or space, or 3 or more
+			// of a character that has a font code. a normal single-character escape is never written as a repetition.
+			if (the_run >= 2 &&
+			    (isspecial || 32 == the_char || the_run >= 3) &&
+			    (32 == the_char || !(escape_p[0] & TOKEN_END_BIT)))
+			{
+				PROFILE_COUNT(repeats_written_);
+				
+				if (32 == the_char)
+				{
+					output_p += sprintf(output_p, "{space*%u}", the_run);
+				}
+				else
+				{
+					*(output_p++) = '{';
+					output_p += tokencopy(output_p, escape_p);
+					output_p += sprintf(output_p, "*%u}", the_run);
+				}
+				break;
+			}
+
+			while (the_run--)
+			{
+				if (fontcode)
+				{
+					*(output_p++) = fontcode;
+				}
+				else if (isspecial)
+				{
+					*(output_p++) = '{';
+					output_p += tokencopy(output_p, escape_p);
+					*(output_p++) = '}';
+				}
+				else
+				{
+					*(output_p++) = *escape_p & ~TOKEN_END_BIT;
+				}
+			}
+			break;
+	}
+
+	return (output_p - the_start);
+}
+
+
+//! Back-end: the text listing of the line, as written by detokenize(). the_context: LexerText*
+void Lexer_TextBackEnd(LexerLine* the_line, void* the_context)
+{
+	LexerText*		the_text = (LexerText*)the_context;
+	char*			output_p = the_text->buffer_;
+	LexerItem*		the_item = the_line->items_;
+	uint16_t		i;
+	char			the_plain;
+
+	output_p += sprintf(output_p, "%u ", the_line->line_number_);
+
+	// LOGIC:
+	//   most of a line outside quotes is variable names, numbers, and punctuation, each written as one character.
+	//   those are copied here straight from lexer_plain_char[], so Lexer_ItemText() is only called for the rest
+	for (i = 0; i < the_line->num_items_; i++, the_item++)
+	{
+		if (the_item->kind_ == LEXER_KIND_CHAR && the_item->value_ < 128 && (the_plain = lexer_plain_char[the_item->value_]) != 0)
+		{
+			*(output_p++) = the_plain;
+		}
+		else
+		{
+			output_p += Lexer_ItemText(the_line, the_item, output_p, the_text->flags_);
+		}
+	}
+
+	*output_p++ = '\n';
+	*output_p = 0;
+
+	the_text->len_ = output_p - the_text->buffer_;
+}
+
+
+//! Back-end: one JSON object per line, followed by a newline. the_context: open FILE*
+void Lexer_JSONBackEnd(LexerLine* the_line, void* the_context)
+{
+	FILE*			the_file = (FILE*)the_context;
+	LexerItem*		the_item = the_line->items_;
+	uint16_t		i;
+
+	fprintf(the_file, "{\"line\":%u,\"items\":[", the_line->line_number_);
+
+	for (i = 0; i < the_line->num_items_; i++, the_item++)
+	{
+		fprintf(the_file, "%s{\"kind\":\"%s\",\"at\":%u", (i > 0) ? "," : "", lexer_kind_names[the_item->kind_], the_item->offset_);
+
+		if (the_item->kind_ >= LEXER_KIND_KEYWORD && the_item->kind_ <= LEXER_KIND_KEYWORD_FE)
+		{
+			lexer_item_text[tokencopy(lexer_item_text, Lexer_KeywordText(the_line, the_item))] = 0;
+			fprintf(the_file, ",\"text\":\"%s\"", lexer_item_text);
+		}
+		else if (the_item->kind_ != LEXER_KIND_QUOTE)
+		{
+			fprintf(the_file, ",\"byte\":%u", the_item->value_);
+		}
+
+		if (the_item->run_ > 1)
+		{
+			fprintf(the_file, ",\"run\":%u", the_item->run_);
+		}
+
+		fputc('}', the_file);
+	}
+
+	fprintf(the_file, "]}\n");
+}
+
+
+//! Back-end: highlighting spans for the text listing of the line. the_context: LexerSpans*
+void Lexer_SpansBackEnd(LexerLine* the_line, void* the_context)
+{
+	LexerSpans*		the_spans = (LexerSpans*)the_context;
+	LexerItem*		the_item = the_line->items_;
+	uint16_t		the_column;
+	uint16_t		the_len;
+	uint16_t		i;
+
+	// LOGIC:
+	//   the line number and the space after it are not an item, so the first span starts after them.
+	//   item texts are written to a scratch buffer only to measure them.
+
+	the_spans->num_spans_ = 0;
+	the_column = sprintf(lexer_item_text, "%u ", the_line->line_number_);
+
+	for (i = 0; i < the_line->num_items_; i++)
+	{
+		the_len = Lexer_ItemText(the_line, the_item, lexer_item_text, the_spans->flags_);
+		Lexer_AddSpan(the_spans, the_item->kind_, the_column, the_len);
+		the_column += the_len;
+		++the_item;
+	}
+}
+
+
+//! Back-end: keyword and character counts. the_context: LexerStats*
+void Lexer_StatsBackEnd(LexerLine* the_line, void* the_context)
+{
+	LexerStats*		the_stats = (LexerStats*)the_context;
+	LexerItem*		the_item = the_line->items_;
+	uint16_t		i;
+
+	++the_stats->lines_;
+
+	for (i = 0; i < the_line->num_items_; i++, the_item++)
+	{
+		switch (the_item->kind_)
+		{
+			case LEXER_KIND_KEYWORD:
+				++the_stats->keyword_uses_[the_item->value_ - 128];
+				break;
+
+			case LEXER_KIND_KEYWORD_CE:
+			case LEXER_KIND_KEYWORD_FE:
+				++the_stats->prefixed_keywords_;
+				break;
+
+			case LEXER_KIND_BAD_TOKEN:
+				++the_stats->bad_tokens_;
+				break;
+
+			case LEXER_KIND_STRING:
+				the_stats->string_chars_ += the_item->run_;
+				break;
+
+			default:
+				++the_stats->chars_;
+				break;
+		}
+	}
+}
@@ -0,0 +1,180 @@
+/*
+ * lexer.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+#ifndef LEXER_H
+#define LEXER_H
+
+/* about this module: Lexer
+ *
+ * Decodes one tokenized BASIC line into a compact array of items: what kind of thing each is (keyword, character,
+ * string character, etc.), its token or PETSCII byte, how many times a string character repeats, and where it came
+ * from in the line. All dialect and quote mode rules are applied here, once.
+ *
+ * Back-ends then turn the items into output without looking at the tokenized bytes again: the normal text listing
+ * (what detokenize() returns), JSON, highlighting spans (text column + kind), and keyword statistics. Several back-ends
+ * can be run on the same decoded line.
+ *
+ * The item array lives in the LexerLine, which the caller keeps and reuses for every line, so nothing is allocated.
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "detokenize.h"
+
+// C includes
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define LEXER_MAX_ITEMS				256		// a line is at most 255 bytes, and each item uses at least 1
+
+// item kinds
+#define LEXER_KIND_CHAR				0		// character outside quotes. value_: PETSCII byte
+#define LEXER_KIND_KEYWORD			1		// single-byte token. value_: token (128-254)
+#define LEXER_KIND_KEYWORD_CE		2		// C128 CE-prefixed token. value_: byte after the prefix
+#define LEXER_KIND_KEYWORD_FE		3		// C128 FE-prefixed token. value_: byte after the prefix
+#define LEXER_KIND_BAD_TOKEN		4		// token byte with no keyword in this dialect. value_: the byte
+#define LEXER_KIND_QUOTE			5		// opening or closing double quote
+#define LEXER_KIND_STRING			6		// character inside quotes. value_: PETSCII byte, run_: times it repeats
+#define LEXER_NUM_KINDS				7
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct LexerItem
+{
+	uint8_t			kind_;			// LEXER_KIND_xxx
+	uint8_t			value_;
+	uint8_t			run_;			// number of identical bytes this item stands for (1 unless a string character repeats)
+	uint8_t			offset_;		// offset of the item's first byte in the line data (after the line number)
+} LexerItem;
+
+typedef struct LexerLine
+{
+	uint16_t		line_number_;
+	basic_t			mode_;
+	uint16_t		num_items_;
+	LexerItem		items_[LEXER_MAX_ITEMS];
+} LexerLine;
+
+// a back-end consumes a decoded line. the_context is whatever that back-end writes its output to.
+typedef void (*LexerBackEnd)(LexerLine* the_line, void* the_context);
+
+typedef struct LexerOutput
+{
+	LexerBackEnd	back_end_;
+	void*			context_;
+} LexerOutput;
+
+// context for Lexer_TextBackEnd()
+typedef struct LexerText
+{
+	char*			buffer_;		// must be big enough for the line (see detokenize())
+	uint16_t		len_;			// length written, including the newline
+	uint8_t			flags_;			// DETOKENIZE_FLAG_xxx
+} LexerText;
+
+// context for Lexer_SpansBackEnd(): one span per run of items of the same kind, in text listing columns
+typedef struct LexerSpan
+{
+	uint16_t		column_;
+	uint16_t		len_;
+	uint8_t			kind_;
+} LexerSpan;
+
+typedef struct LexerSpans
+{
+	uint8_t			flags_;			// DETOKENIZE_FLAG_xxx, as the text was (or will be) written with
+	uint16_t		num_spans_;
+	LexerSpan		spans_[LEXER_MAX_ITEMS];
+} LexerSpans;
+
+// context for Lexer_StatsBackEnd(): accumulates over all lines sent to it. zero it before the first line.
+typedef struct LexerStats
+{
+	uint16_t		lines_;
+	uint16_t		keyword_uses_[128];		// uses of each single-byte token 128-255
+	uint16_t		prefixed_keywords_;		// uses of CE/FE-prefixed C128 tokens
+	uint16_t		bad_tokens_;
+	uint32_t		chars_;					// characters outside quotes
+	uint32_t		string_chars_;			// characters inside quotes, counting repeats
+} LexerStats;
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+// keyword limits per dialect, indexed by basic_t (see lexer.c)
+extern uint8_t		lexer_extension_count[];
+extern uint8_t		lexer_ce_end[];
+extern uint8_t		lexer_fe_end[];
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                          */
+/*****************************************************************************/
+
+#ifdef TOKENS_FILE
+//! Make sure the keyword tables of a dialect are loaded (see tokens.h). If they can't be, the dialect's extension
+//! keywords are decoded as bad tokens from then on, and written as {nnn}, as for a dialect left out of the build.
+//! @param	mode: BASIC dialect about to be decoded
+void Lexer_LoadTables(basic_t mode);
+#endif
+
+//! Decode a tokenized line into items
+//! @param	the_line: valid pointer to a LexerLine, which is overwritten
+//! @param	input_p: line number (2 bytes), followed by the tokenized line, null terminated
+//! @param	mode: BASIC dialect to decode tokens for
+void Lexer_Line(LexerLine* the_line, const char* input_p, basic_t mode);
+
+//! Run each of the passed back-ends on a decoded line
+//! @param	the_line: valid pointer to a decoded line
+//! @param	the_outputs: array of back-end + context pairs
+//! @param	num_outputs: number of entries in the_outputs
+void Lexer_Emit(LexerLine* the_line, LexerOutput* the_outputs, uint8_t num_outputs);
+
+//! Get the keyword text of a LEXER_KIND_KEYWORD, _KEYWORD_CE, or _KEYWORD_FE item
+//! @param	the_line: valid pointer to a decoded line (for its dialect)
+//! @param	the_item: valid pointer to a keyword item in the_line
+//! @return	Returns the keyword, in upper case, packed (see tokens.h)
+const unsigned char* Lexer_KeywordText(LexerLine* the_line, LexerItem* the_item);
+
+//! Write the text of one item, as it appears in the text listing
+//! @param	the_line: valid pointer to a decoded line
+//! @param	the_item: valid pointer to an item in the_line
+//! @param	output_p: buffer to write to. It is not null terminated.
+//! @param	flags: DETOKENIZE_FLAG_xxx options
+//! @return	Returns the number of characters written
+uint16_t Lexer_ItemText(LexerLine* the_line, LexerItem* the_item, char* output_p, uint8_t flags);
+
+//! Back-end: the text listing of the line, as written by detokenize(). the_context: LexerText*
+void Lexer_TextBackEnd(LexerLine* the_line, void* the_context);
+
+//! Back-end: one JSON object per line, followed by a newline. the_context: open FILE*
+void Lexer_JSONBackEnd(LexerLine* the_line, void* the_context);
+
+//! Back-end: highlighting spans for the text listing of the line. the_context: LexerSpans*
+void Lexer_SpansBackEnd(LexerLine* the_line, void* the_context);
+
+//! Back-end: keyword and character counts. the_context: LexerStats*
+void Lexer_StatsBackEnd(LexerLine* the_line, void* the_context);
+
+
+#endif /* LEXER_H */
@@ -0,0 +1,336 @@
+;
+; lexer65.s
+;
+;  Created on: Oct 18, 2026
+;      Author: micahbly
+;
+; 65C02 version of Lexer_Line(), the per-byte loop of the conversion. It replaces the C version in lexer.c when the
+; program is built with LEXER_ASM defined (e.g. -DLEXER_ASM, and this file added to the build). The C version is the
+; reference, and is what other systems use: both must fill in the LexerLine exactly the same way.
+;
+; Instead of the C version's compare cascade, each byte outside quotes is looked up in a 256-byte class table, and
+; dispatched with jmp (abs,x). Only tokens 204-254 depend on the dialect, and they are checked against small tables
+; indexed by basic_t. Inside quotes, the only bytes that matter are the closing quote and the end of the line, so
+; strings have their own loop, which also counts runs of identical bytes.
+;
+; Pointers are kept in the cc65 runtime's zero page temporaries:
+;   ptr1: next byte of the line to read
+;   ptr2: the LexerLine
+;   ptr3 + y: the item being written. y steps through the 4 bytes of each item, and ptr3 moves up a page every 64.
+;   tmp4: pages of items left. the line ends when it reaches 0, after LEXER_MAX_ITEMS (256) items, as in the C version.
+;   tmp1, tmp2, tmp3: value_, run_, offset_ of the item being decoded
+;   sreg: low byte of the start of the line data (for offset_), sreg+1: the dialect
+;
+; void __fastcall__ Lexer_Line(LexerLine* the_line, const char* input_p, basic_t mode);
+
+        .setcpu     "65C02"
+
+        .export     _Lexer_Line
+        .import     popax
+        .import     _lexer_extension_count, _lexer_ce_end, _lexer_fe_end
+.ifdef TOKENS_FILE
+        .import     _Lexer_LoadTables
+.endif
+        .importzp   ptr1, ptr2, ptr3, tmp1, tmp2, tmp3, tmp4, sreg
+
+
+; LexerLine and LexerItem layout (see lexer.h). basic_t is an int under cc65.
+LINE_NUMBER         = 0
+LINE_MODE           = 2
+LINE_NUM_ITEMS      = 4
+LINE_ITEMS          = 6
+
+; item kinds (see lexer.h)
+KIND_CHAR           = 0
+KIND_KEYWORD        = 1
+KIND_KEYWORD_CE     = 2
+KIND_KEYWORD_FE     = 3
+KIND_BAD_TOKEN      = 4
+KIND_QUOTE          = 5
+KIND_STRING         = 6
+
+; byte classes outside quotes, as offsets into class_handlers
+CLASS_END           = 0
+CLASS_QUOTE         = 2
+CLASS_CHAR          = 4
+CLASS_BASIC2        = 6         ; tokens 128-203
+CLASS_EXTENSION     = 8         ; tokens 204-254: depends on the dialect
+
+CH_QUOTE            = 34
+TOKEN_PREFIX_CE     = $CE
+TOKEN_PREFIX_FE     = $FE
+FIRST_EXTENSION     = 204
+
+; the keyword limits of each dialect are lexer.c's lexer_extension_count, lexer_ce_end and lexer_fe_end, indexed by
+; basic_t, so a dialect left out of the build (see detokenize.h) or whose tables can't be loaded has none. with
+; TOKENS_FILE defined (pass it to the assembler too, e.g. --asm-define TOKENS_FILE), Lexer_LoadTables() sees to that
+; before each line.
+
+
+; write the item: a = kind_, then value_, run_, offset_ from tmp1-3. moves ptr3 + y to the next item, and ends the
+; line if the items are full.
+.macro  EmitItem
+        .local  same_page
+        sta     (ptr3),y
+        iny
+        lda     tmp1
+        sta     (ptr3),y
+        iny
+        lda     tmp2
+        sta     (ptr3),y
+        iny
+        lda     tmp3
+        sta     (ptr3),y
+        iny
+        bne     same_page
+        jsr     next_page
+same_page:
+.endmacro
+
+; read the next byte of the line into a and tmp1, and its offset into tmp3. moves ptr1 past it. flags are not set.
+.macro  ReadByte
+        .local  same_page
+        lda     ptr1
+        sec
+        sbc     sreg
+        sta     tmp3
+        lda     (ptr1)
+        sta     tmp1
+        inc     ptr1
+        bne     same_page
+        inc     ptr1+1
+same_page:
+.endmacro
+
+; move ptr1 past the byte after a CE/FE prefix
+.macro  SkipByte
+        .local  same_page
+        inc     ptr1
+        bne     same_page
+        inc     ptr1+1
+same_page:
+.endmacro
+
+
+.segment    "CODE"
+
+.proc   _Lexer_Line
+.ifdef TOKENS_FILE
+        pha                         ; mode. nothing is in the zero page temporaries yet, so the call can use them
+        jsr     _Lexer_LoadTables   ; x is still the high byte of mode
+        pla
+.endif
+        sta     sreg+1              ; mode: basic_t is 0-8, so only the low byte matters
+        jsr     popax               ; input_p
+        sta     ptr1
+        stx     ptr1+1
+        jsr     popax               ; the_line
+        sta     ptr2
+        stx     ptr2+1
+
+        ; line_number_, then mode_
+        lda     (ptr1)
+        sta     (ptr2)
+        ldy     #LINE_NUMBER+1
+        lda     (ptr1),y
+        sta     (ptr2),y
+        iny
+        lda     sreg+1
+        sta     (ptr2),y
+        iny
+        lda     #0
+        sta     (ptr2),y
+
+        ; the line data starts after the line number
+        clc
+        lda     ptr1
+        adc     #2
+        sta     ptr1
+        sta     sreg
+        bcc     data_same_page
+        inc     ptr1+1
+data_same_page:
+
+        clc
+        lda     ptr2
+        adc     #LINE_ITEMS
+        sta     ptr3
+        lda     ptr2+1
+        adc     #0
+        sta     ptr3+1
+        ldy     #0
+        lda     #4                  ; 256 items of 4 bytes
+        sta     tmp4
+
+        lda     #1                  ; run_ is 1 for everything but string characters
+        sta     tmp2
+
+; outside quotes
+code_loop:
+        ReadByte
+        tax
+        lda     byte_class,x
+        tax
+        jmp     (class_handlers,x)
+
+is_char:
+        lda     #KIND_CHAR
+        EmitItem
+        bra     code_loop
+
+is_basic2:
+        lda     #KIND_KEYWORD
+        EmitItem
+        bra     code_loop
+
+is_extension:
+        ldx     sreg+1
+        lda     tmp1
+        cmp     #TOKEN_PREFIX_CE
+        beq     check_ce
+        cmp     #TOKEN_PREFIX_FE
+        beq     check_fe
+
+check_extension:
+        ; the extension tables are shorter than 204-254: anything past their end is not a keyword
+        lda     tmp1
+        sec
+        sbc     #FIRST_EXTENSION
+        cmp     _lexer_extension_count,x
+        bcs     is_bad_token
+        lda     #KIND_KEYWORD
+        EmitItem
+        jmp     code_loop
+
+is_bad_token:
+        lda     #KIND_BAD_TOKEN
+        EmitItem
+        jmp     code_loop
+
+check_ce:
+        lda     (ptr1)              ; byte after the prefix. the line's null stops it being read past the end.
+        cmp     #2
+        bcc     check_extension
+        cmp     _lexer_ce_end,x
+        bcs     check_extension
+        sta     tmp1
+        SkipByte
+        lda     #KIND_KEYWORD_CE
+        EmitItem
+        jmp     code_loop
+
+check_fe:
+        lda     (ptr1)
+        cmp     #2
+        bcc     check_extension
+        cmp     _lexer_fe_end,x
+        bcs     check_extension
+        sta     tmp1
+        SkipByte
+        lda     #KIND_KEYWORD_FE
+        EmitItem
+        jmp     code_loop
+
+is_quote:
+        lda     #KIND_QUOTE
+        EmitItem
+        ; fall through into quote mode
+
+; inside quotes
+string_loop:
+        ReadByte
+        tax                         ; ReadByte's last inc left the flags for ptr1, not the byte
+        beq     done
+        cmp     #CH_QUOTE
+        beq     close_quote
+
+        ; count the identical bytes that follow. neither the null nor a quote can match, so the run stops in the string.
+        ldx     #1
+count_run:
+        cmp     (ptr1)
+        bne     end_run
+        inx
+        inc     ptr1
+        bne     count_run
+        inc     ptr1+1
+        bra     count_run
+end_run:
+        stx     tmp2
+        lda     #KIND_STRING
+        EmitItem
+        lda     #1
+        sta     tmp2
+        bra     string_loop
+
+close_quote:
+        lda     #KIND_QUOTE
+        EmitItem
+        jmp     code_loop
+
+; ptr3 moves up a page. once the items are full, the line ends there instead of returning to the caller's loop.
+next_page:
+        inc     ptr3+1
+        dec     tmp4
+        beq     items_full
+        rts
+items_full:
+        pla
+        pla
+
+; end of line: num_items_ = (ptr3 + y - first item) / 4
+done:
+        tya
+        clc
+        adc     ptr3
+        sta     tmp1
+        lda     ptr3+1
+        adc     #0
+        sta     tmp2
+        sec
+        lda     tmp1
+        sbc     ptr2
+        sta     tmp1
+        lda     tmp2
+        sbc     ptr2+1
+        sta     tmp2
+        sec
+        lda     tmp1
+        sbc     #LINE_ITEMS
+        sta     tmp1
+        lda     tmp2
+        sbc     #0
+        lsr     a
+        ror     tmp1
+        lsr     a
+        ror     tmp1
+        ldy     #LINE_NUM_ITEMS+1
+        sta     (ptr2),y
+        dey
+        lda     tmp1
+        sta     (ptr2),y
+        rts
+.endproc
+
+
+.segment    "RODATA"
+
+class_handlers:
+        .word   _Lexer_Line::done, _Lexer_Line::is_quote, _Lexer_Line::is_char, _Lexer_Line::is_basic2
+        .word   _Lexer_Line::is_extension
+
+; class of each byte outside quotes. page aligned, so indexing it never costs an extra cycle.
+        .align  256
+byte_class:
+        .repeat 256, I
+            .if I = 0
+                .byte   CLASS_END
+            .elseif I = CH_QUOTE
+                .byte   CLASS_QUOTE
+            .elseif I >= 128 && I < FIRST_EXTENSION
+                .byte   CLASS_BASIC2
+            .elseif I >= FIRST_EXTENSION && I <= 254
+                .byte   CLASS_EXTENSION
+            .else
+                .byte   CLASS_CHAR
+            .endif
+        .endrepeat
@@ -0,0 +1,456 @@
+/*
+ * lineindex.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+ 
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+
+// project includes
+#include "lineindex.h"
+#include "detokenize.h"
+#include "select.h"
+#ifdef EXTMEM
+#include "extmem.h"
+#endif
+
+// C includes
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// cc65 includes
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define LINEINDEX_LOAD_CHUNK		1024	// program buffer grows by this much while reading the file
+#define LINEINDEX_MAX_LINE			256		// longest line the link checks allow, terminator included
+#define LINEINDEX_MIN_LINE			5		// shortest: link (2), line number (2) and terminator
+
+
+/*****************************************************************************/
+/*                          File-Scope Variables                             */
+/*****************************************************************************/
+
+#ifdef EXTMEM
+// the line last copied out of extended RAM by LineIndex_GetLine(). static because cc65 doesn't like creating that much on the stack.
+static uint8_t		lineindex_line[LINEINDEX_MAX_LINE];
+#endif
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+// read the rest of the file into a newly allocated buffer (with EXTMEM, into extended RAM)
+// returns false if nothing could be read or memory could not be allocated
+bool LineIndex_ReadProgram(LineIndex* the_index, FILE* in_file);
+
+// walk the link chain, calling with the_entries == NULL to only count lines
+// returns the number of valid lines found
+uint16_t LineIndex_WalkLinks(LineIndex* the_index, LineIndexEntry* the_entries);
+
+// sort the index entries by line number. Only needed for programs whose lines were linked out of order.
+void LineIndex_SortEntries(LineIndex* the_index);
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+
+// read the rest of the file into a newly allocated buffer (with EXTMEM, into extended RAM)
+// returns false if nothing could be read or memory could not be allocated
+bool LineIndex_ReadProgram(LineIndex* the_index, FILE* in_file)
+{
+#ifndef EXTMEM
+	uint8_t*	the_buffer = NULL;
+	uint8_t*	the_new_buffer;
+	uint16_t	the_capacity = 0;
+	uint16_t	bytes_read;
+#endif
+	uint16_t	the_len = 0;
+	uint16_t	max_len;
+	
+	// a program can't extend past the top of the CBM's 64K
+	max_len = 0xFFFF - the_index->start_addr_;
+	
+#ifdef EXTMEM
+	// program_ stays NULL: lines are copied out of extended RAM as they are needed (see LineIndex_GetLine())
+	the_len = ExtMem_Load(in_file, max_len);
+	
+	if (the_len < 2)
+	{
+		return false;
+	}
+#else
+	do
+	{
+		the_new_buffer = (uint8_t*)realloc(the_buffer, the_capacity + LINEINDEX_LOAD_CHUNK);
+		
+		if (the_new_buffer == NULL)
+		{
+			free(the_buffer);
+			return false;
+		}
+		
+		the_buffer = the_new_buffer;
+		bytes_read = fread(the_buffer + the_len, 1, LINEINDEX_LOAD_CHUNK, in_file);
+		the_len += bytes_read;
+		the_capacity += LINEINDEX_LOAD_CHUNK;
+	} while (bytes_read == LINEINDEX_LOAD_CHUNK && the_capacity < max_len);
+	
+	if (the_len < 2)
+	{
+		free(the_buffer);
+		return false;
+	}
+	
+	the_index->program_ = the_buffer;
+#endif
+	the_index->program_len_ = the_len;
+	
+	return true;
+}
+
+
+// walk the link chain, calling with the_entries == NULL to only count lines
+// returns the number of valid lines found
+uint16_t LineIndex_WalkLinks(LineIndex* the_index, LineIndexEntry* the_entries)
+{
+	uint8_t*	the_line;
+#ifdef EXTMEM
+	uint8_t		the_header[4];
+	uint8_t		the_last;
+#endif
+	uint16_t	the_offset = 0;
+	uint16_t	the_addr = the_index->start_addr_;
+	uint16_t	nextadr;
+	uint16_t	the_count = 0;
+	
+	/* Line format is this:
+	 *  [0-1]- address to next line
+	 *  [2-3]- line number
+	 *  [4-n]- tokenized line, null terminated
+	 * Only the link address, line number and terminator are looked at here.
+	 */
+	while (the_offset + 4 <= the_index->program_len_)
+	{
+#ifdef EXTMEM
+		ExtMem_Copy(the_header, the_offset, 4);
+		the_line = the_header;
+#else
+		the_line = the_index->program_ + the_offset;
+#endif
+		nextadr = the_line[0] | (the_line[1] << 8);
+		
+		/* Address to next line is null when the program is ended.
+		 * Address to next line must be higher than the current address.
+		 * The line cannot be longer than 256 bytes, or shorter than its link, line number and terminator,
+		 * and must be complete in the buffer
+		 */
+		if (nextadr == 0 || nextadr <= the_addr || nextadr - the_addr >= LINEINDEX_MAX_LINE ||
+		    nextadr - the_addr < LINEINDEX_MIN_LINE ||
+		    the_offset + (nextadr - the_addr) > the_index->program_len_)
+		{
+			break;
+		}
+		
+		/* The last byte of the line must be its terminator: detokenize reads up to the first null, and without one
+		 * it would run on into the lines after it
+		 */
+#ifdef EXTMEM
+		ExtMem_Copy(&the_last, the_offset + (nextadr - the_addr) - 1, 1);
+		
+		if (the_last != 0)
+#else
+		if (the_line[nextadr - the_addr - 1] != 0)
+#endif
+		{
+			break;
+		}
+		
+		if (the_entries != NULL)
+		{
+			the_entries[the_count].line_number_ = the_line[2] | (the_line[3] << 8);
+			the_entries[the_count].offset_ = the_offset;
+		}
+		
+		++the_count;
+		the_offset += nextadr - the_addr;
+		the_addr = nextadr;
+	}
+	
+	return the_count;
+}
+
+
+// sort the index entries by line number. Only needed for programs whose lines were linked out of order.
+void LineIndex_SortEntries(LineIndex* the_index)
+{
+	LineIndexEntry*	the_entries = the_index->entries_;
+	LineIndexEntry	the_entry;
+	uint16_t		i;
+	uint16_t		j;
+	
+	// LOGIC: 
+	//   BASIC keeps lines in order, so this normally finds nothing to do after one pass.
+	//   insertion sort is cheap for (nearly) sorted data, and needs no extra memory
+	
+	for (i = 1; i < the_index->num_lines_; i++)
+	{
+		the_entry = the_entries[i];
+		
+		for (j = i; j > 0 && the_entries[j - 1].line_number_ > the_entry.line_number_; j--)
+		{
+			the_entries[j] = the_entries[j - 1];
+			the_index->reordered_ = true;
+		}
+		
+		the_entries[j] = the_entry;
+	}
+}
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+//! Read a whole BASIC program into memory and index its lines
+//! @param	in_file: open file, positioned just after the 2-byte start address
+//! @param	cbm_addr: the start address of the program
+//! @param	flags: DETOKENIZE_FLAG_xxx options passed on to detokenize
+//! @return	Returns NULL if the program could not be read or has no valid lines, or memory could not be allocated
+LineIndex* LineIndex_New(FILE* in_file, uint16_t cbm_addr, uint8_t flags)
+{
+	LineIndex*	the_index;
+	uint16_t	i;
+	detect_t	the_detect;
+	
+	the_index = (LineIndex*)calloc(1, sizeof(LineIndex));
+	
+	if (the_index == NULL)
+	{
+		return NULL;
+	}
+	
+	the_index->start_addr_ = cbm_addr;
+	the_index->flags_ = flags;
+	
+	for (i = 0; i < LINEINDEX_CACHE_SIZE; i++)
+	{
+		the_index->cache_[i].line_index_ = LINEINDEX_NOT_FOUND;
+	}
+	
+	if (LineIndex_ReadProgram(the_index, in_file) == false)
+	{
+		goto error;
+	}
+	
+	// LOGIC: 
+	//   walk the links once to count the lines, so the index can be allocated at exactly the right size, then again to fill it in
+	
+	the_index->num_lines_ = LineIndex_WalkLinks(the_index, NULL);
+	
+	if (the_index->num_lines_ == 0)
+	{
+		goto error;
+	}
+	
+	the_index->entries_ = (LineIndexEntry*)malloc(the_index->num_lines_ * sizeof(LineIndexEntry));
+	
+	if (the_index->entries_ == NULL)
+	{
+		goto error;
+	}
+	
+	LineIndex_WalkLinks(the_index, the_index->entries_);
+	
+	// the whole program is in memory, so the dialect is detected from its tokens here, before lines are reordered
+	detect_init(&the_detect);
+	
+	for (i = 0; i < the_index->num_lines_; i++)
+	{
+		if (detect_line(&the_detect, LineIndex_GetLine(the_index, i) + 4))
+		{
+			break;
+		}
+	}
+	
+	the_index->mode_ = detect_result(&the_detect, cbm_addr, NULL);
+	
+	LineIndex_SortEntries(the_index);
+	
+	return the_index;
+	
+error:
+	LineIndex_Destroy(&the_index);
+	return NULL;
+}
+
+
+//! Free the program, index, and cache
+//! @param	the_index: pointer to a valid LineIndex pointer. It will be set to NULL.
+void LineIndex_Destroy(LineIndex** the_index)
+{
+	if (the_index == NULL || *the_index == NULL)
+	{
+		return;
+	}
+	
+	free((*the_index)->entries_);
+	free((*the_index)->program_);
+	free(*the_index);
+	*the_index = NULL;
+}
+
+
+// **** Lookup functions *****
+
+//! Find the first line with a line number equal to or greater than the one passed (binary search)
+//! @param	the_index: valid pointer to a LineIndex
+//! @param	the_line_number: the BASIC line number to look for
+//! @return	Returns the position of the line in the index, or LINEINDEX_NOT_FOUND if all lines are lower
+uint16_t LineIndex_Find(LineIndex* the_index, uint16_t the_line_number)
+{
+	uint16_t	low = 0;
+	uint16_t	high = the_index->num_lines_;
+	uint16_t	mid;
+	
+	while (low < high)
+	{
+		mid = low + ((high - low) >> 1);
+		
+		if (the_index->entries_[mid].line_number_ < the_line_number)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+	
+	if (low >= the_index->num_lines_)
+	{
+		return LINEINDEX_NOT_FOUND;
+	}
+	
+	return low;
+}
+
+
+//! Get the detokenized text of a line, detokenizing it only if it is not already in the cache
+//! @param	the_index: valid pointer to a LineIndex
+//! @param	the_position: position of the line in the index, between 0 and num_lines_ - 1
+//! @return	Returns a pointer to the text (without newline), valid until LINEINDEX_CACHE_SIZE other lines have been asked for. Returns NULL if the_position is out of range.
+char* LineIndex_GetText(LineIndex* the_index, uint16_t the_position)
+{
+	LineCacheSlot*	the_slot;
+	LineCacheSlot*	the_oldest_slot;
+	uint8_t			i;
+	int16_t			detokenized_len;
+	
+	if (the_position >= the_index->num_lines_)
+	{
+		return NULL;
+	}
+	
+	++the_index->use_counter_;
+	the_oldest_slot = &the_index->cache_[0];
+	
+	for (i = 0; i < LINEINDEX_CACHE_SIZE; i++)
+	{
+		the_slot = &the_index->cache_[i];
+		
+		if (the_slot->line_index_ == the_position)
+		{
+			the_slot->last_used_ = the_index->use_counter_;
+			return the_slot->text_;
+		}
+		
+		// LOGIC: compare ages by difference, so the counter wrapping around doesn't matter
+		if ((uint16_t)(the_index->use_counter_ - the_slot->last_used_) > (uint16_t)(the_index->use_counter_ - the_oldest_slot->last_used_))
+		{
+			the_oldest_slot = the_slot;
+		}
+	}
+	
+	// not cached: detokenize into the least recently used slot. skip the 2-byte link address.
+	detokenized_len = detokenize((char*)LineIndex_GetLine(the_index, the_position) + 2, the_oldest_slot->text_, the_index->mode_, the_index->flags_);
+	the_oldest_slot->text_[detokenized_len - 1] = '\0';	// drop the newline
+	the_oldest_slot->line_index_ = the_position;
+	the_oldest_slot->last_used_ = the_index->use_counter_;
+	
+	return the_oldest_slot->text_;
+}
+
+
+//! Get the bytes of a line: link address (2), line number (2), tokenized data, and the terminator
+//! @param	the_index: valid pointer to a LineIndex
+//! @param	the_position: position of the line in the index, between 0 and num_lines_ - 1
+//! @return	Returns a pointer to the line. With EXTMEM, the line is copied out of extended RAM, and the pointer is only good until the next call.
+uint8_t* LineIndex_GetLine(LineIndex* the_index, uint16_t the_position)
+{
+	uint16_t	the_offset = the_index->entries_[the_position].offset_;
+#ifdef EXTMEM
+	uint16_t	the_len;
+	
+	// LOGIC:
+	//   the link address gives the length. WalkLinks already checked it is complete, 5-255 bytes and null terminated, but it is
+	//   clamped again, as it is used to copy into lineindex_line: a bad length must not write past it.
+	ExtMem_Copy(lineindex_line, the_offset, 2);
+	the_len = (lineindex_line[0] | (lineindex_line[1] << 8)) - (the_index->start_addr_ + the_offset);
+	
+	if (the_len < LINEINDEX_MIN_LINE)
+	{
+		the_len = LINEINDEX_MIN_LINE;
+	}
+	else if (the_len > LINEINDEX_MAX_LINE)
+	{
+		the_len = LINEINDEX_MAX_LINE;
+	}
+	
+	ExtMem_Copy(lineindex_line + 2, the_offset + 2, the_len - 2);
+	lineindex_line[the_len - 1] = 0;
+	
+	return lineindex_line;
+#else
+	return the_index->program_ + the_offset;
+#endif
+}
+
+
+//! Detokenize as many whole lines as fit into a buffer, each followed by a newline, as in the text listing. Lines are independent of each other once the links are known, so a program can be converted in chunks of any size; unless reordered_ is set, the chunks put together are exactly what inconvert() writes.
+//! @param	the_index: valid pointer to a LineIndex
+//! @param	the_position: position of the first line to detokenize. It is moved past the last line written.
+//! @param	the_buffer: where to write the text. It is not null terminated.
+//! @param	the_size: size of the_buffer. Lines are only written while LINEINDEX_TEXT_LEN bytes are left.
+//! @return	Returns the number of bytes written, 0 once all lines have been written
+uint16_t LineIndex_TextChunk(LineIndex* the_index, uint16_t* the_position, char* the_buffer, uint16_t the_size)
+{
+	uint16_t	the_len = 0;
+	
+	// LOGIC: 
+	//   detokenize() starts every line outside quotes, so no state carries over from one line, or one chunk, to the next
+	
+	while (*the_position < the_index->num_lines_ && the_size - the_len >= LINEINDEX_TEXT_LEN)
+	{
+		the_len += detokenize((char*)LineIndex_GetLine(the_index, *the_position) + 2, the_buffer + the_len, the_index->mode_, the_index->flags_);
+		++*the_position;
+	}
+	
+	return the_len;
+}
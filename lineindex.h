@@ -0,0 +1,123 @@
+/*
+ * lineindex.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+ 
+
+#ifndef LINEINDEX_H
+#define LINEINDEX_H
+
+/* about this module: LineIndex
+ *
+ * Holds a whole tokenized BASIC program in memory, with a sorted index of line number -> offset.
+ * The index is built by walking only the link chain; no line is detokenized until it is asked for.
+ * Detokenized lines are kept in a small LRU cache, so redrawing recently viewed lines is free.
+ * Built with EXTMEM defined, the program is kept in the F256's extended RAM instead (see ExtMem), and lines are
+ * copied out of it one at a time.
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "detokenize.h"
+
+// C includes
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define LINEINDEX_CACHE_SIZE		4		// number of detokenized lines kept
+#define LINEINDEX_TEXT_LEN			512		// size of the detokenize output buffer for each cached line
+#define LINEINDEX_NOT_FOUND			0xFFFF
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct LineIndexEntry
+{
+	uint16_t		line_number_;
+	uint16_t		offset_;			// offset of the line's link address in program_
+} LineIndexEntry;
+
+typedef struct LineCacheSlot
+{
+	uint16_t		line_index_;		// index into entries_ of the line held here, or LINEINDEX_NOT_FOUND
+	uint16_t		last_used_;			// value of the index's use counter when this slot was last read
+	char			text_[LINEINDEX_TEXT_LEN];
+} LineCacheSlot;
+
+typedef struct LineIndex
+{
+	uint8_t*		program_;			// program bytes, starting with the link address of the first line. NULL with EXTMEM: use LineIndex_GetLine()
+	uint16_t		program_len_;
+	uint16_t		start_addr_;		// CBM address of program_[0]
+	basic_t			mode_;				// detected from the program's tokens (see detectbasic())
+	uint8_t			flags_;				// DETOKENIZE_FLAG_xxx options passed on to detokenize
+	uint16_t		num_lines_;
+	LineIndexEntry*	entries_;			// sorted by line number
+	bool			reordered_;			// true if sorting moved any line: the link order is not the line number order
+	uint16_t		use_counter_;
+	LineCacheSlot	cache_[LINEINDEX_CACHE_SIZE];
+} LineIndex;
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                          */
+/*****************************************************************************/
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+//! Read a whole BASIC program into memory and index its lines
+//! @param	in_file: open file, positioned just after the 2-byte start address
+//! @param	cbm_addr: the start address of the program
+//! @param	flags: DETOKENIZE_FLAG_xxx options passed on to detokenize
+//! @return	Returns NULL if the program could not be read or has no valid lines, or memory could not be allocated
+LineIndex* LineIndex_New(FILE* in_file, uint16_t cbm_addr, uint8_t flags);
+
+//! Free the program, index, and cache
+//! @param	the_index: pointer to a valid LineIndex pointer. It will be set to NULL.
+void LineIndex_Destroy(LineIndex** the_index);
+
+
+// **** Lookup functions *****
+
+//! Find the first line with a line number equal to or greater than the one passed (binary search)
+//! @param	the_index: valid pointer to a LineIndex
+//! @param	the_line_number: the BASIC line number to look for
+//! @return	Returns the position of the line in the index, or LINEINDEX_NOT_FOUND if all lines are lower
+uint16_t LineIndex_Find(LineIndex* the_index, uint16_t the_line_number);
+
+//! Get the detokenized text of a line, detokenizing it only if it is not already in the cache
+//! @param	the_index: valid pointer to a LineIndex
+//! @param	the_position: position of the line in the index, between 0 and num_lines_ - 1
+//! @return	Returns a pointer to the text (without newline), valid until LINEINDEX_CACHE_SIZE other lines have been asked for. Returns NULL if the_position is out of range.
+char* LineIndex_GetText(LineIndex* the_index, uint16_t the_position);
+
+//! Get the bytes of a line: link address (2), line number (2), tokenized data, and the terminator
+//! @param	the_index: valid pointer to a LineIndex
+//! @param	the_position: position of the line in the index, between 0 and num_lines_ - 1
+//! @return	Returns a pointer to the line. With EXTMEM, the line is copied out of extended RAM, and the pointer is only good until the next call.
+uint8_t* LineIndex_GetLine(LineIndex* the_index, uint16_t the_position);
+
+//! Detokenize as many whole lines as fit into a buffer, each followed by a newline, as in the text listing. Lines are independent of each other once the links are known, so a program can be converted in chunks of any size; unless reordered_ is set, the chunks put together are exactly what inconvert() writes.
+//! @param	the_index: valid pointer to a LineIndex
+//! @param	the_position: position of the first line to detokenize. It is moved past the last line written.
+//! @param	the_buffer: where to write the text. It is not null terminated.
+//! @param	the_size: size of the_buffer. Lines are only written while LINEINDEX_TEXT_LEN bytes are left.
+//! @return	Returns the number of bytes written, 0 once all lines have been written
+uint16_t LineIndex_TextChunk(LineIndex* the_index, uint16_t* the_position, char* the_buffer, uint16_t the_size);
+
+
+#endif /* LINEINDEX_H */
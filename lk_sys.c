@@ -37,6 +37,12 @@ uint8_t			overlay_bank_value_kernel;	// stores value for the physical bank point
 
 #define ZP_OLD_IO_PAGE		0x20	// zero-page address holding the original IO page # before being changed
 
+#ifndef MMU_MEM_CTRL
+#	define MMU_MEM_CTRL		0x0000	// bits 0-1: active LUT; bits 4-5: LUT being edited; bit 7: edit enable
+#	define MMU_MEM_BANK_0	0x0008	// 8 registers, one per CPU slot, holding the physical bank mapped into it
+#endif
+#define MMU_EDIT_EN			0x80	// MMU_MEM_CTRL bit that makes the MMU_MEM_BANK_x registers readable and writable
+
 
 
 /*****************************************************************************/
@@ -617,5 +623,24 @@ void Sys_RestoreIOPage(void)
 {
 	asm("lda %b", ZP_OLD_IO_PAGE);	// we stashed the previous IO page at ZP_OLD_IO_PAGE
 	asm("sta $01");	// switch back to the previous IO setting
+}
+
+
+// map an 8K bank of physical memory into one of the CPU's 8 slots (slot 0 = 0000-1FFF ... slot 7 = E000-FFFF)
+// returns the bank that was mapped into the slot before, so it can be restored
+uint8_t Sys_MapBank(uint8_t the_slot, uint8_t the_bank)
+{
+	uint8_t		the_mem_ctrl = R8(MMU_MEM_CTRL);
+	uint8_t		the_old_bank;
+	
+	// LOGIC:
+	//   the slot registers are only visible while a LUT is being edited. editing the active LUT makes the change
+	//   take effect at once, so the active LUT is picked as the one to edit.
+	R8(MMU_MEM_CTRL) = MMU_EDIT_EN | ((the_mem_ctrl & 0x03) << 4) | (the_mem_ctrl & 0x03);
+	the_old_bank = R8(MMU_MEM_BANK_0 + the_slot);
+	R8(MMU_MEM_BANK_0 + the_slot) = the_bank;
+	R8(MMU_MEM_CTRL) = the_mem_ctrl;
+	
+	return the_old_bank;
 }	
 	
@@ -209,6 +209,13 @@ void Sys_SwapIOPage(uint8_t the_page_number);
 void Sys_RestoreIOPage(void);
 
 
+// **** Memory bank functions *****
+
+// map an 8K bank of physical memory into one of the CPU's 8 slots (slot 0 = 0000-1FFF ... slot 7 = E000-FFFF)
+// returns the bank that was mapped into the slot before, so it can be restored
+uint8_t Sys_MapBank(uint8_t the_slot, uint8_t the_bank);
+
+
 
 
 // **** Debug functions *****
@@ -47,6 +47,9 @@
 
 int8_t*	global_temp_buff_384b;
 
+static uint8_t	invert_attr_lut[256];			// built the first time Text_InvertBox() is called
+static bool		invert_attr_lut_ready = false;
+
 extern System*			global_system;
 
 
@@ -398,37 +401,52 @@ bool Text_FillBoxAttrOnly(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_
 //! @return	Returns false on any error/invalid input.
 bool Text_InvertBox(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
 {
-	uint8_t			the_attribute_value;
-	uint8_t			the_inversed_value;
+	// LOGIC: 
+	//   the invert table is only built the first time it is needed. After that, inverting is a straight table lookup per cell
+	
+	if (invert_attr_lut_ready == false)
+	{
+		Text_MakeInvertAttrLUT(invert_attr_lut);
+		invert_attr_lut_ready = true;
+	}
+	
+	return Text_TransformBoxAttr(x1, y1, x2, y2, invert_attr_lut);
+}
+
+
+//! Replace every attribute value in a rectangular block with its entry in a 256-byte lookup table.
+//! The whole block is done with one I/O page swap, and one table lookup per cell.
+//! @param	x1: the leftmost horizontal position, between 0 and the screen's text_cols_vis_ - 1
+//! @param	y1: the uppermost vertical position, between 0 and the screen's text_rows_vis_ - 1
+//! @param	x2: the rightmost horizontal position, between 0 and the screen's text_cols_vis_ - 1
+//! @param	y2: the lowermost vertical position, between 0 and the screen's text_rows_vis_ - 1
+//! @param	the_lut: valid pointer to 256 bytes. The existing attribute value is used as the index, and the byte found there is written back. See Text_MakeInvertAttrLUT() etc.
+//! @return	Returns false on any error/invalid input.
+bool Text_TransformBoxAttr(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, const uint8_t* the_lut)
+{
 	uint8_t*		the_write_loc;
 	uint8_t			the_col;
-	uint8_t			skip_len;
-	uint8_t			back_nibble;
-	uint8_t			fore_nibble;
+	uint8_t			the_width;
 	
+	if (x1 > x2 || y1 > y2 || the_lut == NULL)
+	{
+		return false;
+	}
+
 	// get initial read/write loc
 	the_write_loc = Text_GetMemLocForXY(x1, y1);	
-	
-	// amount of cells to skip past once we have written the specified line len
-	skip_len = SCREEN_NUM_COLS - (x2 - x1) - 1;
+	the_width = x2 - x1 + 1;
 
 	Sys_SwapIOPage(VICKY_IO_PAGE_ATTR_MEM);
 	
 	for (; y1 <= y2; y1++)
 	{
-		for (the_col = x1; the_col <= x2; the_col++)
+		for (the_col = 0; the_col < the_width; the_col++)
 		{
-			the_attribute_value = (unsigned char)*the_write_loc;
-			
-			// LOGIC: text mode only supports 16 colors. lower 4 bits are back, upper 4 bits are foreground
-			back_nibble = ((the_attribute_value & 0xF0) >> 4);
-			fore_nibble = ((the_attribute_value & 0x0F) << 4);
-			the_inversed_value = (fore_nibble | back_nibble);
-			
-			*the_write_loc++ = the_inversed_value;
+			the_write_loc[the_col] = the_lut[the_write_loc[the_col]];
 		}
 
-		the_write_loc += skip_len;
+		the_write_loc += SCREEN_NUM_COLS;
 	}
 		
 	Sys_RestoreIOPage();
@@ -439,6 +457,128 @@ bool Text_InvertBox(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
 
 
 
+// **** Attribute lookup table functions *****
+
+// LOGIC: text mode only supports 16 colors. lower 4 bits are back, upper 4 bits are foreground
+//   each table is indexed by the current attribute value, and holds the new attribute value
+
+
+//! Fill a 256-byte attribute lookup table that swaps foreground and background colors
+//! @param	the_lut: valid pointer to 256 bytes that will be filled in
+void Text_MakeInvertAttrLUT(uint8_t* the_lut)
+{
+	uint8_t		i = 0;
+	
+	do
+	{
+		the_lut[i] = (uint8_t)((i << 4) | (i >> 4));
+	} while (++i != 0);
+}
+
+
+//! Fill a 256-byte attribute lookup table that changes one specific foreground/background pair to another, leaving all other attribute values as they are
+//! @param	the_lut: valid pointer to 256 bytes that will be filled in
+//! @param	from_fore: foreground color (0-15) of the cells to be recolored
+//! @param	from_back: background color (0-15) of the cells to be recolored
+//! @param	to_fore: new foreground color (0-15) for those cells
+//! @param	to_back: new background color (0-15) for those cells
+void Text_MakeRecolorAttrLUT(uint8_t* the_lut, uint8_t from_fore, uint8_t from_back, uint8_t to_fore, uint8_t to_back)
+{
+	uint8_t		i = 0;
+	
+	do
+	{
+		the_lut[i] = i;
+	} while (++i != 0);
+	
+	the_lut[(from_fore << 4) | from_back] = ((to_fore << 4) | to_back);
+}
+
+
+//! Fill a 256-byte attribute lookup table that dims the foreground color (bright colors become their normal version, white becomes gray), leaving the background as is
+//! @param	the_lut: valid pointer to 256 bytes that will be filled in
+void Text_MakeDimAttrLUT(uint8_t* the_lut)
+{
+	uint8_t		i = 0;
+	uint8_t		fore_color;
+	
+	do
+	{
+		fore_color = i >> 4;
+		
+		if (fore_color > COLOR_GRAY)
+		{
+			fore_color -= 8;
+		}
+		else if (fore_color == COLOR_WHITE)
+		{
+			fore_color = COLOR_GRAY;
+		}
+		
+		the_lut[i] = (uint8_t)((fore_color << 4) | (i & 0x0F));
+	} while (++i != 0);
+}
+
+
+//! Fill a 256-byte attribute lookup table that sets the background of every cell to the passed color, leaving the foreground as is
+//! @param	the_lut: valid pointer to 256 bytes that will be filled in
+//! @param	back_color: Index to the desired background color (0-15).
+void Text_MakeHighlightAttrLUT(uint8_t* the_lut, uint8_t back_color)
+{
+	uint8_t		i = 0;
+	
+	do
+	{
+		the_lut[i] = (uint8_t)((i & 0xF0) | back_color);
+	} while (++i != 0);
+}
+
+
+
+
+// **** Scrolling functions ****
+
+//! Scroll a band of full-width rows up, filling the rows revealed at the bottom with spaces in the passed colors
+//! @param	y1: the uppermost row of the band, between 0 and the screen's text_rows_vis_ - 1
+//! @param	y2: the lowermost row of the band, between 0 and the screen's text_rows_vis_ - 1
+//! @param	num_rows: number of rows to scroll by. Must be between 1 and the height of the band.
+//! @param	fore_color: Index to the desired foreground color (0-15) for the revealed rows.
+//! @param	back_color: Index to the desired background color (0-15) for the revealed rows.
+//! @return	Returns false on any error/invalid input.
+bool Text_ScrollRowsUp(uint8_t y1, uint8_t y2, uint8_t num_rows, uint8_t fore_color, uint8_t back_color)
+{
+	uint8_t*	the_write_loc;
+	uint16_t	the_move_len;
+	
+	if (y1 > y2 || num_rows == 0 || num_rows > (y2 - y1 + 1))
+	{
+		return false;
+	}
+
+	// LOGIC: 
+	//   On F256jr, the write len and write locs are same for char and attr memory, difference is IO page 2 or 3
+	//   rows are always 80 wide in VRAM, so the band is one contiguous block, and can be moved with a single memmove per page
+
+	the_write_loc = Text_GetMemLocForXY(0, y1);
+	the_move_len = (uint16_t)(y2 - y1 + 1 - num_rows) * SCREEN_NUM_COLS;
+	
+	if (the_move_len > 0)
+	{
+		Sys_SwapIOPage(VICKY_IO_PAGE_CHAR_MEM);
+		memmove(the_write_loc, the_write_loc + (num_rows * SCREEN_NUM_COLS), the_move_len);
+		Sys_RestoreIOPage();
+
+		Sys_SwapIOPage(VICKY_IO_PAGE_ATTR_MEM);
+		memmove(the_write_loc, the_write_loc + (num_rows * SCREEN_NUM_COLS), the_move_len);
+		Sys_RestoreIOPage();
+	}
+	
+	return Text_FillBox(0, y2 - num_rows + 1, SCREEN_NUM_COLS - 1, y2, ' ', fore_color, back_color);
+}
+
+
+
+
 // **** FONT RELATED *****
 
 //! replace the current font data with the data at the passed memory buffer
@@ -23,6 +23,7 @@
  * clear / fill an entire screen of text characters
  * clear / fill an entire screen of text attributes
  * invert the colors of a screen
+ * transform the attributes of a rectangular area through a 256-byte lookup table (invert, recolor, dim, highlight)
  * clear / fill a smaller-than-screen rectangular area of text/attrs
  * Draw a char to a specified x, y coord
  * Get the currently displayed character at the specified coord
@@ -292,6 +293,52 @@ bool Text_FillBoxAttrOnly(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_
 //! @return	Returns false on any error/invalid input.
 bool Text_InvertBox(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
 
+//! Replace every attribute value in a rectangular block with its entry in a 256-byte lookup table.
+//! The whole block is done with one I/O page swap, and one table lookup per cell.
+//! @param	x1: the leftmost horizontal position, between 0 and the screen's text_cols_vis_ - 1
+//! @param	y1: the uppermost vertical position, between 0 and the screen's text_rows_vis_ - 1
+//! @param	x2: the rightmost horizontal position, between 0 and the screen's text_cols_vis_ - 1
+//! @param	y2: the lowermost vertical position, between 0 and the screen's text_rows_vis_ - 1
+//! @param	the_lut: valid pointer to 256 bytes. The existing attribute value is used as the index, and the byte found there is written back. See Text_MakeInvertAttrLUT() etc.
+//! @return	Returns false on any error/invalid input.
+bool Text_TransformBoxAttr(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, const uint8_t* the_lut);
+
+
+// **** Attribute lookup table functions *****
+
+//! Fill a 256-byte attribute lookup table that swaps foreground and background colors
+//! @param	the_lut: valid pointer to 256 bytes that will be filled in
+void Text_MakeInvertAttrLUT(uint8_t* the_lut);
+
+//! Fill a 256-byte attribute lookup table that changes one specific foreground/background pair to another, leaving all other attribute values as they are
+//! @param	the_lut: valid pointer to 256 bytes that will be filled in
+//! @param	from_fore: foreground color (0-15) of the cells to be recolored
+//! @param	from_back: background color (0-15) of the cells to be recolored
+//! @param	to_fore: new foreground color (0-15) for those cells
+//! @param	to_back: new background color (0-15) for those cells
+void Text_MakeRecolorAttrLUT(uint8_t* the_lut, uint8_t from_fore, uint8_t from_back, uint8_t to_fore, uint8_t to_back);
+
+//! Fill a 256-byte attribute lookup table that dims the foreground color (bright colors become their normal version, white becomes gray), leaving the background as is
+//! @param	the_lut: valid pointer to 256 bytes that will be filled in
+void Text_MakeDimAttrLUT(uint8_t* the_lut);
+
+//! Fill a 256-byte attribute lookup table that sets the background of every cell to the passed color, leaving the foreground as is
+//! @param	the_lut: valid pointer to 256 bytes that will be filled in
+//! @param	back_color: Index to the desired background color (0-15).
+void Text_MakeHighlightAttrLUT(uint8_t* the_lut, uint8_t back_color);
+
+
+// **** Scrolling functions ****
+
+//! Scroll a band of full-width rows up, filling the rows revealed at the bottom with spaces in the passed colors
+//! @param	y1: the uppermost row of the band, between 0 and the screen's text_rows_vis_ - 1
+//! @param	y2: the lowermost row of the band, between 0 and the screen's text_rows_vis_ - 1
+//! @param	num_rows: number of rows to scroll by. Must be between 1 and the height of the band.
+//! @param	fore_color: Index to the desired foreground color (0-15) for the revealed rows.
+//! @param	back_color: Index to the desired background color (0-15) for the revealed rows.
+//! @return	Returns false on any error/invalid input.
+bool Text_ScrollRowsUp(uint8_t y1, uint8_t y2, uint8_t num_rows, uint8_t fore_color, uint8_t back_color);
+
 
 // **** FONT RELATED *****
 
@@ -0,0 +1,102 @@
+/* outmode.c
+ * - Routines for converting text to binary
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "outmode.h"
+#include "tokenize.h"
+
+#include "basic2text.h"
+
+// made next 2 static because cc65 doesn't like creating that much on the stack.
+static char text[512];
+static unsigned char buf[256];
+
+
+/* outconvert
+ * - performs the conversion from text to a tokenized program
+ * in:	in_file - open text file, in the format inconvert writes
+ * 		out_file - open file, to write the program to
+ *		cbm_addr - start address to link the program for
+ *		mode - BASIC dialect to tokenize for
+ *		line_count_p - number of text lines read is returned here. On
+ *		               error, this is the line that failed.
+ * out:	ERROR_xxx code
+ */
+uint8_t outconvert(FILE* in_file, FILE* out_file, uint16_t cbm_addr, basic_t mode, uint16_t* line_count_p)
+{
+	uint32_t	nextadr;
+	int			tokenized_len;
+	char*		ch_p;
+
+	*line_count_p = 0;
+
+	/* Start address first, as in any CBM program file */
+	fputc(cbm_addr & 0xFF, out_file);
+	fputc(cbm_addr >> 8, out_file);
+
+	/* Each text line becomes:
+	 *  [0-1]- address to next line
+	 *  [2-3]- line number                     \_ from
+	 *  [4-n]- tokenized line, null terminated /  tokenize
+	 */
+	while (fgets(text, sizeof(text), in_file) != NULL)
+	{
+		++(*line_count_p);
+
+		/* A line that doesn't fit the buffer can't be a valid BASIC line */
+		if (strchr(text, '\n') == NULL && !feof(in_file))
+		{
+			return ERROR_INVALID_TEXT_LINE;
+		}
+
+		/* Skip empty lines */
+		for (ch_p = text; *ch_p == ' ' || *ch_p == '\t'; ch_p++);
+
+		if (*ch_p == '\n' || *ch_p == '\r' || *ch_p == '\0')
+		{
+			continue;
+		}
+
+		tokenized_len = tokenize(ch_p, buf, mode);
+
+		if (tokenized_len < 0)
+		{
+			return ERROR_INVALID_TEXT_LINE;
+		}
+
+		/* Keywords are only recognized in upper case, as inconvert writes them */
+		if (tokenize_lowercase)
+		{
+			printf("Warning: text line %u has a keyword in lower case, kept as letters. \n", *line_count_p);
+		}
+
+		nextadr = (uint32_t)cbm_addr + 2 + tokenized_len;
+
+		/* The program, and the end marker after it, must fit below 64K */
+		if (nextadr + 2 > 0xFFFF)
+		{
+			return ERROR_SAVE_BUFFER_TOO_SMALL;
+		}
+
+		fputc(nextadr & 0xFF, out_file);
+		fputc(nextadr >> 8, out_file);
+
+		if (fwrite(buf, 1, tokenized_len, out_file) != (size_t)tokenized_len)
+		{
+			return ERROR_SAVE_DATA_INTEGRITY;
+		}
+
+		cbm_addr = nextadr;
+	}
+
+	/* Address to next line is null when the program is ended */
+	fputc(0, out_file);
+	fputc(0, out_file);
+
+	return ERROR_NO_ERROR;
+}
@@ -0,0 +1,22 @@
+#ifndef OUTMODE_H
+#define OUTMODE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "detokenize.h"
+
+
+/* outconvert
+ * - performs the conversion from text to a tokenized program
+ * in:	in_file - open text file, in the format inconvert writes
+ * 		out_file - open file, to write the program to
+ *		cbm_addr - start address to link the program for
+ *		mode - BASIC dialect to tokenize for
+ *		line_count_p - number of text lines read is returned here. On
+ *		               error, this is the line that failed.
+ * out:	ERROR_xxx code
+ */
+uint8_t outconvert(FILE* in_file, FILE* out_file, uint16_t cbm_addr, basic_t mode, uint16_t* line_count_p);
+
+#endif /* OUTMODE_H */
@@ -0,0 +1,709 @@
+/*
+ * preview.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+ 
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+
+// project includes
+#include "preview.h"
+#include "basic2text.h"
+#include "detokenize.h"
+#include "lineindex.h"
+#include "search.h"
+#include "select.h"
+#include "lk_text.h"
+#include "lk_sys.h"
+
+// C includes
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// cc65 includes
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define PREVIEW_FIRST_ROW			0
+#define PREVIEW_TEXT_FORE_COLOR		COLOR_BRIGHT_WHITE
+#define PREVIEW_TEXT_BACK_COLOR		COLOR_BLACK
+#define PREVIEW_STATUS_FORE_COLOR	COLOR_BLACK
+#define PREVIEW_STATUS_BACK_COLOR	COLOR_BRIGHT_CYAN
+
+#define PREVIEW_HIGHLIGHT_BACK_COLOR	COLOR_BLUE		// background of the line found by F
+
+#define PREVIEW_STATUS_MORE			"SPACE: next page  DOWN: next line  G: go to line  F: find  Q: quit"
+#define PREVIEW_STATUS_END			"-- end of program --  G: go to line  F: find  Q: quit"
+#define PREVIEW_STATUS_GOTO			"Go to line: "
+#define PREVIEW_STATUS_FIND			"Find (ENTER: find again): "
+#define PREVIEW_STATUS_NOT_FOUND	"Not found"
+#define PREVIEW_STATUS_BAD_FIND		"Could not translate search text"
+#define PREVIEW_STATUS_NO_INDEX		"Could not load program for line index"
+
+#define PREVIEW_MAX_LINE_NUM_LEN	5	// CBM line numbers go up to 63999
+#define PREVIEW_MAX_FIND_LEN		40
+
+
+/*****************************************************************************/
+/*                          File-Scope Variables                             */
+/*****************************************************************************/
+
+// static because cc65 doesn't like creating that much on the stack.
+static char			buf[256];
+static char			text[512];
+
+static FILE*		preview_file;
+static char*		preview_filename;		// used to re-read the whole program when the user first jumps to a line
+static LineIndex*	preview_index;			// NULL until the user first jumps to a line
+static uint16_t		preview_next_position;	// position in preview_index of the next line, once it exists
+static char*		preview_text;			// detokenized line to draw next: either text, or a line in the index cache
+static uint16_t		preview_addr;			// CBM address of the next line to be read
+static basic_t		preview_mode;
+static uint8_t		preview_flags;
+static bool			preview_at_end;
+static uint16_t		preview_text_len;		// length of the detokenized line in text, without the newline
+static uint16_t		preview_line_number;	// BASIC line number of the line in text
+
+static uint16_t		preview_top_position;	// position of the line at the top of the page
+static uint16_t		preview_top_line;		// BASIC line number of the line at the top of the page
+static uint16_t		preview_row_position[PHYSICAL_SCREEN_NUM_ROWS];	// line shown on each row, or LINEINDEX_NOT_FOUND
+static uint16_t		preview_row_line[PHYSICAL_SCREEN_NUM_ROWS];		// BASIC line number of the line shown on each row
+static uint16_t		preview_found_position;	// position of the line last found with F, or LINEINDEX_NOT_FOUND
+static char			preview_find_text[PREVIEW_MAX_FIND_LEN+1];
+static uint8_t		preview_highlight_lut[256];
+static bool			preview_highlight_lut_ready;
+
+static uint8_t		preview_num_cols;
+static uint8_t		preview_last_row;		// last row used for program text. status bar is drawn on the row below
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+extern System*		global_system;
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+// read the next line of the program, and detokenize it into text
+// returns false if there are no more lines (or the program data is invalid)
+bool Preview_ReadNextLine(void);
+
+// calculate how many screen rows the line currently in text will need
+uint8_t Preview_RowsForLine(void);
+
+// draw the line currently in text, starting at row y, wrapping at the right edge of the screen
+void Preview_DrawLine(uint8_t y);
+
+// record that the line in text, drawn at row y, takes up the_rows rows
+void Preview_SetRowPosition(uint8_t y, uint8_t the_rows);
+
+// draw the status bar under the program text
+void Preview_DrawStatus(void);
+
+// show a message on the status bar, and wait for a key
+void Preview_ShowMessage(char* the_message);
+
+// get text typed by the user on the status bar, after the_prompt
+// if digits_only is true, other characters are ignored
+// returns the number of characters typed, or -1 if the user pressed ESC
+int8_t Preview_GetStatusInput(char* the_prompt, char* the_buffer, uint8_t the_max_len, bool digits_only);
+
+// get a line number typed by the user on the status bar, after the go-to prompt
+// returns false if no digits were typed
+bool Preview_GetLineNumber(uint16_t* the_line_number);
+
+// read the whole program into a line index, if not already done
+// returns false if the index could not be built
+bool Preview_BuildIndex(void);
+
+// ask the user for a line number, and switch to reading lines from the line index, starting at that line
+// the index is built the first time this is called
+// returns false if the user didn't enter a number, or the index could not be built
+bool Preview_GoToLine(void);
+
+// ask the user for search text, and switch to reading lines from the line index, starting at the next line containing it
+// ENTER on its own repeats the previous search, starting after the line last found
+// returns false if the user canceled, the text was not found, or the index could not be built
+bool Preview_Find(void);
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+
+// read the next line of the program, and detokenize it into text
+// returns false if there are no more lines (or the program data is invalid)
+bool Preview_ReadNextLine(void)
+{
+	int16_t		addr_lo;
+	int16_t		addr_hi;
+	uint16_t	nextadr;
+	uint16_t	expected_len;
+	int16_t		detokenized_len;
+	
+	if (preview_at_end)
+	{
+		return false;
+	}
+	
+	// once the line index exists, lines come from it instead of from the file
+	if (preview_index != NULL)
+	{
+		preview_text = LineIndex_GetText(preview_index, preview_next_position);
+		
+		if (preview_text == NULL)
+		{
+			preview_at_end = true;
+			return false;
+		}
+		
+		preview_line_number = preview_index->entries_[preview_next_position].line_number_;
+		++preview_next_position;
+		preview_text_len = strlen(preview_text);
+		return true;
+	}
+	
+	/* Line format is this:
+	 *  [0-1]- address to next line
+	 *  [2-3]- line number                     \_ sent to
+	 *  [4-n]- tokenized line, null terminated /  detokenize
+	 */
+	addr_lo = fgetc(preview_file);
+	addr_hi = fgetc(preview_file);
+	
+	if (addr_lo < 0 || addr_hi < 0)
+	{
+		preview_at_end = true;
+		return false;
+	}
+	
+	nextadr = addr_lo + (addr_hi << 8);
+
+	/* Address to next line is null when the program is ended.
+	 * Address to next line must be higher than the current address.
+	 * The line cannot be longer than 256 bytes
+	 */
+	if (nextadr == 0 || nextadr <= preview_addr || nextadr - preview_addr >= 256)
+	{
+		preview_at_end = true;
+		return false;
+	}
+	
+	expected_len = nextadr - preview_addr - 2;
+
+	if (fread(buf, 1, expected_len, preview_file) != expected_len)
+	{
+		preview_at_end = true;
+		return false;
+	}
+	
+	preview_addr = nextadr;
+	preview_line_number = (uint8_t)buf[0] | ((uint8_t)buf[1] << 8);
+	++preview_next_position;
+	
+	detokenized_len = detokenize(buf, text, preview_mode, preview_flags);
+	
+	// drop the newline: each line is placed on screen explicitly
+	preview_text_len = detokenized_len - 1;
+	text[preview_text_len] = '\0';
+	preview_text = text;
+	
+	return true;
+}
+
+
+// calculate how many screen rows the line currently in text will need
+uint8_t Preview_RowsForLine(void)
+{
+	uint8_t		the_rows;
+	
+	the_rows = (preview_text_len + preview_num_cols - 1) / preview_num_cols;
+	
+	if (the_rows == 0)
+	{
+		the_rows = 1;
+	}
+	
+	// a line too long for the text area is cut off at the bottom of it
+	if (the_rows > preview_last_row - PREVIEW_FIRST_ROW + 1)
+	{
+		the_rows = preview_last_row - PREVIEW_FIRST_ROW + 1;
+	}
+	
+	return the_rows;
+}
+
+
+// record that the line in text, drawn at row y, takes up the_rows rows
+void Preview_SetRowPosition(uint8_t y, uint8_t the_rows)
+{
+	while (the_rows--)
+	{
+		preview_row_line[y] = preview_line_number;
+		preview_row_position[y++] = preview_next_position - 1;
+	}
+}
+
+
+// draw the line currently in text, starting at row y, wrapping at the right edge of the screen
+void Preview_DrawLine(uint8_t y)
+{
+	char*		the_segment = preview_text;
+	uint16_t	remaining_len = preview_text_len;
+	char		the_saved_char;
+	
+	// LOGIC:
+	//   Text_DrawStringAtXY() truncates at the right edge, so long lines are drawn one screen-width segment at a time,
+	//   temporarily terminating the string at the end of each segment
+	
+	do
+	{
+		if (remaining_len > preview_num_cols)
+		{
+			the_saved_char = the_segment[preview_num_cols];
+			the_segment[preview_num_cols] = '\0';
+			Text_DrawStringAtXY(0, y, the_segment, PREVIEW_TEXT_FORE_COLOR, PREVIEW_TEXT_BACK_COLOR);
+			the_segment[preview_num_cols] = the_saved_char;
+			the_segment += preview_num_cols;
+			remaining_len -= preview_num_cols;
+		}
+		else
+		{
+			Text_DrawStringAtXY(0, y, the_segment, PREVIEW_TEXT_FORE_COLOR, PREVIEW_TEXT_BACK_COLOR);
+			remaining_len = 0;
+		}
+		
+		++y;
+	} while (remaining_len > 0 && y <= preview_last_row);
+}
+
+
+// draw the status bar under the program text
+void Preview_DrawStatus(void)
+{
+	uint8_t		the_status_row = preview_last_row + 1;
+	
+	Text_FillBox(0, the_status_row, preview_num_cols - 1, the_status_row, ' ', PREVIEW_STATUS_FORE_COLOR, PREVIEW_STATUS_BACK_COLOR);
+	
+	if (preview_at_end)
+	{
+		Text_DrawStringAtXY(0, the_status_row, PREVIEW_STATUS_END, PREVIEW_STATUS_FORE_COLOR, PREVIEW_STATUS_BACK_COLOR);
+	}
+	else
+	{
+		Text_DrawStringAtXY(0, the_status_row, PREVIEW_STATUS_MORE, PREVIEW_STATUS_FORE_COLOR, PREVIEW_STATUS_BACK_COLOR);
+	}
+}
+
+
+// show a message on the status bar, and wait for a key
+void Preview_ShowMessage(char* the_message)
+{
+	uint8_t			the_status_row = preview_last_row + 1;
+	
+	Text_FillBox(0, the_status_row, preview_num_cols - 1, the_status_row, ' ', PREVIEW_STATUS_FORE_COLOR, PREVIEW_STATUS_BACK_COLOR);
+	Text_DrawStringAtXY(0, the_status_row, the_message, PREVIEW_STATUS_FORE_COLOR, PREVIEW_STATUS_BACK_COLOR);
+	getchar();
+}
+
+
+// get text typed by the user on the status bar, after the_prompt
+// if digits_only is true, other characters are ignored
+// returns the number of characters typed, or -1 if the user pressed ESC
+int8_t Preview_GetStatusInput(char* the_prompt, char* the_buffer, uint8_t the_max_len, bool digits_only)
+{
+	uint8_t			the_status_row = preview_last_row + 1;
+	uint8_t			x = strlen(the_prompt);
+	uint8_t			the_len = 0;
+	uint8_t			the_char;
+	
+	Text_FillBox(0, the_status_row, preview_num_cols - 1, the_status_row, ' ', PREVIEW_STATUS_FORE_COLOR, PREVIEW_STATUS_BACK_COLOR);
+	Text_DrawStringAtXY(0, the_status_row, the_prompt, PREVIEW_STATUS_FORE_COLOR, PREVIEW_STATUS_BACK_COLOR);
+
+	while ( (the_char = getchar() ) != CH_ENTER)
+	{
+		if (the_char == CH_ESC)
+		{
+			return -1;
+		}
+		
+		if ((the_char == CH_DEL || the_char == CH_CURS_LEFT) && the_len > 0)
+		{
+			--the_len;
+			--x;
+			Text_SetCharAtXY(x, the_status_row, ' ');
+		}
+		else if (the_len < the_max_len && x < preview_num_cols &&
+		         ((the_char >= '0' && the_char <= '9') || (digits_only == false && the_char >= ' ' && the_char < 127)))
+		{
+			the_buffer[the_len++] = the_char;
+			Text_SetCharAtXY(x, the_status_row, the_char);
+			++x;
+		}
+	}
+	
+	the_buffer[the_len] = '\0';
+	
+	return the_len;
+}
+
+
+// get a line number typed by the user on the status bar, after the go-to prompt
+// returns false if no digits were typed
+bool Preview_GetLineNumber(uint16_t* the_line_number)
+{
+	char			the_digits[PREVIEW_MAX_LINE_NUM_LEN+1];
+	char*			the_digit = the_digits;
+	
+	*the_line_number = 0;
+	
+	if (Preview_GetStatusInput(PREVIEW_STATUS_GOTO, the_digits, PREVIEW_MAX_LINE_NUM_LEN, true) < 1)
+	{
+		return false;
+	}
+	
+	while (*the_digit != '\0')
+	{
+		*the_line_number = (*the_line_number * 10) + (*the_digit++ - '0');
+	}
+	
+	return true;
+}
+
+
+// read the whole program into a line index, if not already done
+// returns false if the index could not be built
+bool Preview_BuildIndex(void)
+{
+	FILE*			the_file;
+	int16_t			addr_lo;
+	int16_t			addr_hi;
+	uint16_t		the_position;
+	uint8_t			y;
+	
+	// LOGIC:
+	//   the file was only read as far as the user has paged, so the first jump or find reads the whole program from the start.
+	//   after that, every jump is a binary search plus (at most) one detokenize per line shown
+	
+	if (preview_index != NULL)
+	{
+		return true;
+	}
+	
+	the_file = fopen(preview_filename, "r");
+	
+	if (the_file == NULL)
+	{
+		return false;
+	}
+	
+	addr_lo = fgetc(the_file);
+	addr_hi = fgetc(the_file);
+	
+	if (addr_lo >= 0 && addr_hi >= 0)
+	{
+		preview_index = LineIndex_New(the_file, addr_lo + (addr_hi << 8), preview_flags);
+	}
+	
+	fclose(the_file);
+	
+	if (preview_index == NULL)
+	{
+		Preview_ShowMessage(PREVIEW_STATUS_NO_INDEX);
+		return false;
+	}
+	
+	// lines from the index must look the same as the ones already shown
+	preview_index->mode_ = preview_mode;
+	
+	// LOGIC:
+	//   until now, positions counted the lines in link order, as they were read. the index is sorted by line number,
+	//   and stops at a bad link streaming may have got past, so the lines already shown are found in it again by number.
+	//   the pending line becomes the one before preview_next_position, as it would be if it had come from the index.
+	
+	for (y = PREVIEW_FIRST_ROW; y <= preview_last_row; y++)
+	{
+		if (preview_row_position[y] != LINEINDEX_NOT_FOUND)
+		{
+			preview_row_position[y] = LineIndex_Find(preview_index, preview_row_line[y]);
+		}
+	}
+	
+	if (preview_top_position != LINEINDEX_NOT_FOUND)
+	{
+		preview_top_position = LineIndex_Find(preview_index, preview_top_line);
+	}
+	
+	the_position = LineIndex_Find(preview_index, preview_line_number);
+	preview_next_position = (the_position == LINEINDEX_NOT_FOUND) ? preview_index->num_lines_ : the_position + 1;
+	
+	return true;
+}
+
+
+// ask the user for a line number, and switch to reading lines from the line index, starting at that line
+// the index is built the first time this is called
+// returns false if the user didn't enter a number, or the index could not be built
+bool Preview_GoToLine(void)
+{
+	uint16_t		the_line_number;
+	uint16_t		the_position;
+	
+	if (Preview_GetLineNumber(&the_line_number) == false)
+	{
+		return false;
+	}
+	
+	if (Preview_BuildIndex() == false)
+	{
+		return false;
+	}
+	
+	the_position = LineIndex_Find(preview_index, the_line_number);
+	
+	if (the_position == LINEINDEX_NOT_FOUND)
+	{
+		// past the last line: show the last line
+		the_position = preview_index->num_lines_ - 1;
+	}
+	
+	preview_next_position = the_position;
+	preview_at_end = false;
+	
+	return true;
+}
+
+
+// ask the user for search text, and switch to reading lines from the line index, starting at the next line containing it
+// ENTER on its own repeats the previous search, starting after the line last found
+// returns false if the user canceled, the text was not found, or the index could not be built
+bool Preview_Find(void)
+{
+	static SearchPattern	the_pattern;
+	char					the_text[PREVIEW_MAX_FIND_LEN+1];
+	int8_t					the_len;
+	uint16_t				the_position;
+	
+	the_len = Preview_GetStatusInput(PREVIEW_STATUS_FIND, the_text, PREVIEW_MAX_FIND_LEN, false);
+	
+	if (the_len < 0 || (the_len == 0 && preview_find_text[0] == '\0'))
+	{
+		return false;
+	}
+	
+	if (Preview_BuildIndex() == false)
+	{
+		return false;
+	}
+	
+	if (the_len > 0)
+	{
+		if (Search_CompilePattern(&the_pattern, the_text, preview_index->mode_) == false)
+		{
+			Preview_ShowMessage(PREVIEW_STATUS_BAD_FIND);
+			return false;
+		}
+		
+		strcpy(preview_find_text, the_text);
+	}
+	
+	// search from the top of the page, or from just after it if the line at the top is the one found last time
+	the_position = preview_top_position;
+	
+	if (the_position == preview_found_position)
+	{
+		++the_position;
+	}
+	
+	the_position = Search_FindNext(preview_index, &the_pattern, the_position);
+	
+	if (the_position == LINEINDEX_NOT_FOUND)
+	{
+		Preview_ShowMessage(PREVIEW_STATUS_NOT_FOUND);
+		return false;
+	}
+	
+	preview_found_position = the_position;
+	preview_next_position = the_position;
+	preview_at_end = false;
+	
+	return true;
+}
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+//! Show a BASIC program on screen, one screenful at a time, until the user quits or the program ends
+//! @param	the_filename: name of the file, used to read the whole program again if the user jumps to a line
+//! @param	in_file: open file, positioned just after the 2-byte start address
+//! @param	cbm_addr: the start address of the program
+//! @param	mode: BASIC dialect of the program (see detectbasic())
+//! @param	flags: DETOKENIZE_FLAG_xxx options passed on to detokenize
+//! @return	Returns false if the start address is not one of a BASIC program
+bool Preview_Show(char* the_filename, FILE* in_file, uint16_t cbm_addr, basic_t mode, uint8_t flags)
+{
+	uint8_t		y;
+	uint8_t		the_rows;
+	uint8_t		the_char;
+	uint8_t		the_top_rows;
+	bool		have_pending_line;
+	
+	if (cbm_addr != 0x0401 && cbm_addr != 0x0801 && cbm_addr != 0x1c01 &&
+	    cbm_addr != 0x4001 && cbm_addr != 0x132D)
+	{
+		return false;
+	}
+	
+	preview_file = in_file;
+	preview_filename = the_filename;
+	preview_index = NULL;
+	preview_next_position = 0;
+	preview_found_position = LINEINDEX_NOT_FOUND;
+	preview_addr = cbm_addr;
+	preview_mode = mode;
+	preview_flags = flags;
+	preview_at_end = false;
+	preview_num_cols = global_system->text_cols_vis_;
+	preview_last_row = global_system->text_rows_vis_ - 2;
+	
+	if (preview_highlight_lut_ready == false)
+	{
+		Text_MakeHighlightAttrLUT(preview_highlight_lut, PREVIEW_HIGHLIGHT_BACK_COLOR);
+		preview_highlight_lut_ready = true;
+	}
+	
+	Text_ClearScreen(PREVIEW_TEXT_FORE_COLOR, PREVIEW_TEXT_BACK_COLOR);
+	
+	// LOGIC:
+	//   only as many lines as fit on the screen are read and detokenized before the first screen is shown.
+	//   a line that doesn't fit on the current page is kept in text, and becomes the first line of the next one.
+	
+	have_pending_line = Preview_ReadNextLine();
+	
+	while (true)
+	{
+		// fill a page, starting from the top
+		preview_top_position = (have_pending_line) ? preview_next_position - 1 : LINEINDEX_NOT_FOUND;
+		preview_top_line = preview_line_number;
+		the_top_rows = Preview_RowsForLine();
+		
+		for (y = PREVIEW_FIRST_ROW; y <= preview_last_row; y++)
+		{
+			preview_row_position[y] = LINEINDEX_NOT_FOUND;
+		}
+		
+		y = PREVIEW_FIRST_ROW;
+		
+		while (have_pending_line)
+		{
+			the_rows = Preview_RowsForLine();
+
+			if (y + the_rows - 1 > preview_last_row)
+			{
+				break;
+			}
+			
+			Preview_DrawLine(y);
+			Preview_SetRowPosition(y, the_rows);
+			y += the_rows;
+			have_pending_line = Preview_ReadNextLine();
+		}
+		
+		// a line found with F is always at the top of the page
+		if (preview_found_position == preview_top_position && preview_found_position != LINEINDEX_NOT_FOUND)
+		{
+			Text_TransformBoxAttr(0, PREVIEW_FIRST_ROW, preview_num_cols - 1, PREVIEW_FIRST_ROW + the_top_rows - 1, preview_highlight_lut);
+		}
+		
+		Preview_DrawStatus();
+
+		// scroll line by line until user asks for a new page
+		while (true)
+		{
+			the_char = getchar();
+			
+			if (the_char == 'q' || the_char == 'Q' || the_char == CH_ESC)
+			{
+				LineIndex_Destroy(&preview_index);
+				return true;
+			}
+			
+			if (the_char == 'g' || the_char == 'G')
+			{
+				if (Preview_GoToLine())
+				{
+					have_pending_line = Preview_ReadNextLine();
+					Text_FillBox(0, PREVIEW_FIRST_ROW, preview_num_cols - 1, preview_last_row, ' ', PREVIEW_TEXT_FORE_COLOR, PREVIEW_TEXT_BACK_COLOR);
+					break;
+				}
+				
+				Preview_DrawStatus();
+				continue;
+			}
+			
+			if (the_char == 'f' || the_char == 'F')
+			{
+				if (Preview_Find())
+				{
+					have_pending_line = Preview_ReadNextLine();
+					Text_FillBox(0, PREVIEW_FIRST_ROW, preview_num_cols - 1, preview_last_row, ' ', PREVIEW_TEXT_FORE_COLOR, PREVIEW_TEXT_BACK_COLOR);
+					break;
+				}
+				
+				Preview_DrawStatus();
+				continue;
+			}
+			
+			if (have_pending_line == false)
+			{
+				continue;
+			}
+			
+			if (the_char == ' ')
+			{
+				Text_FillBox(0, PREVIEW_FIRST_ROW, preview_num_cols - 1, preview_last_row, ' ', PREVIEW_TEXT_FORE_COLOR, PREVIEW_TEXT_BACK_COLOR);
+				break;
+			}
+			
+			if (the_char == CH_CURS_DOWN)
+			{
+				the_rows = Preview_RowsForLine();
+				Text_ScrollRowsUp(PREVIEW_FIRST_ROW, preview_last_row, the_rows, PREVIEW_TEXT_FORE_COLOR, PREVIEW_TEXT_BACK_COLOR);
+				Preview_DrawLine(preview_last_row - the_rows + 1);
+				
+				// the lines on screen move up with the rows. the top line is now the first one with a row still showing:
+				// F searches from it, and a page drawn from it again would start there.
+				memmove(&preview_row_position[PREVIEW_FIRST_ROW], &preview_row_position[PREVIEW_FIRST_ROW + the_rows], (preview_last_row - PREVIEW_FIRST_ROW + 1 - the_rows) * sizeof(uint16_t));
+				Preview_SetRowPosition(preview_last_row - the_rows + 1, the_rows);
+				
+				for (y = PREVIEW_FIRST_ROW; preview_row_position[y] == LINEINDEX_NOT_FOUND; y++)
+				{
+				}
+				
+				preview_top_position = preview_row_position[y];
+				preview_top_line = preview_row_line[y];
+				have_pending_line = Preview_ReadNextLine();
+				Preview_DrawStatus();
+			}
+		}
+	}
+}
@@ -0,0 +1,47 @@
+/*
+ * preview.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+ 
+
+#ifndef PREVIEW_H
+#define PREVIEW_H
+
+/* about this module: Preview
+ *
+ * Shows a tokenized BASIC program directly on the text screen, without writing anything to storage.
+ * Only the lines needed to fill the screen are read and detokenized; further lines are read as the user scrolls.
+ * Jumping to a line number reads the whole program once into a LineIndex; from then on lines come from the index.
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "detokenize.h"
+
+// C includes
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                          */
+/*****************************************************************************/
+
+//! Show a BASIC program on screen, one screenful at a time, until the user quits or the program ends
+//! @param	the_filename: name of the file, used to read the whole program again if the user jumps to a line
+//! @param	in_file: open file, positioned just after the 2-byte start address
+//! @param	cbm_addr: the start address of the program
+//! @param	mode: BASIC dialect of the program (see detectbasic())
+//! @param	flags: DETOKENIZE_FLAG_xxx options passed on to detokenize
+//! @return	Returns false if the start address is not one of a BASIC program
+bool Preview_Show(char* the_filename, FILE* in_file, uint16_t cbm_addr, basic_t mode, uint8_t flags);
+
+
+#endif /* PREVIEW_H */
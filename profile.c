@@ -0,0 +1,149 @@
+/*
+ * profile.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+
+// project includes
+#include "profile.h"
+
+#ifdef PROFILE
+
+// C includes
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// cc65 includes
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#ifdef __CC65__
+	#define PROFILE_TICKS_PER_SEC	CLOCKS_PER_SEC		// jiffies
+#else
+	#define PROFILE_TICKS_PER_SEC	1000000				// microseconds
+#endif
+
+
+/*****************************************************************************/
+/*                          File-Scope Variables                             */
+/*****************************************************************************/
+
+static uint32_t		profile_ticks[PROFILE_NUM_PHASES];
+static uint32_t		profile_mark;
+
+static const char*	profile_phase_names[PROFILE_NUM_PHASES] =
+{
+	"read",
+	"decode",
+	"emit",
+	"write",
+	"echo",
+};
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+ProfileCounters		profile_counters;
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+// read the clock, in PROFILE_TICKS_PER_SEC units
+uint32_t Profile_Now(void);
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+
+// read the clock, in PROFILE_TICKS_PER_SEC units
+uint32_t Profile_Now(void)
+{
+#ifdef __CC65__
+	return (uint32_t)clock();
+#else
+	struct timespec	the_time;
+
+	clock_gettime(CLOCK_MONOTONIC, &the_time);
+
+	return (uint32_t)the_time.tv_sec * 1000000 + the_time.tv_nsec / 1000;
+#endif
+}
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+//! Zero all phase times and counters
+void Profile_Reset(void)
+{
+	memset(profile_ticks, 0, sizeof(profile_ticks));
+	memset(&profile_counters, 0, sizeof(ProfileCounters));
+}
+
+
+//! Set the mark the next lap is timed from
+void Profile_Start(void)
+{
+	profile_mark = Profile_Now();
+}
+
+
+//! Add the time since the mark to a phase, and move the mark to now
+//! @param	the_phase: PROFILE_PHASE_xxx
+void Profile_Lap(uint8_t the_phase)
+{
+	uint32_t	the_now = Profile_Now();
+
+	profile_ticks[the_phase] += the_now - profile_mark;
+	profile_mark = the_now;
+}
+
+
+//! Print the time spent in each phase, and its share of the whole conversion, and the counters
+void Profile_Print(void)
+{
+	uint32_t	the_total = 0;
+	uint8_t		i;
+
+	for (i = 0; i < PROFILE_NUM_PHASES; i++)
+	{
+		the_total += profile_ticks[i];
+	}
+
+	printf("Profile (ticks of 1/%lu sec): \n", (unsigned long)PROFILE_TICKS_PER_SEC);
+
+	// LOGIC: cc65 has no floating point, so shares are whole percentages
+	for (i = 0; i < PROFILE_NUM_PHASES; i++)
+	{
+		printf("  %-6s %lu (%lu%%) \n", profile_phase_names[i], (unsigned long)profile_ticks[i], (unsigned long)((the_total > 0) ? (profile_ticks[i] * 100) / the_total : 0));
+	}
+
+	printf("%lu lines: %lu BASIC 2.0 keywords, %lu extension keywords, %lu CE + %lu FE prefixed, %lu bad tokens \n",
+		(unsigned long)profile_counters.lines_, (unsigned long)profile_counters.basic2_keywords_, (unsigned long)profile_counters.extension_keywords_,
+		(unsigned long)profile_counters.ce_prefixes_, (unsigned long)profile_counters.fe_prefixes_, (unsigned long)profile_counters.bad_tokens_);
+	printf("%lu string chars, %lu runs collapsed, %lu written as repeats \n",
+		(unsigned long)profile_counters.string_chars_, (unsigned long)profile_counters.string_runs_, (unsigned long)profile_counters.repeats_written_);
+	printf("%lu block reads, %lu block writes \n", (unsigned long)profile_counters.block_reads_, (unsigned long)profile_counters.block_writes_);
+}
+
+#endif /* PROFILE */
@@ -0,0 +1,114 @@
+/*
+ * profile.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/* about this module: Profile
+ *
+ * Optional instrumentation of the conversion: time spent in each phase of inconvert(), and counts of the events on
+ * the lexer's hot path. It is only compiled in if PROFILE is defined (e.g., -DPROFILE). Otherwise every PROFILE_xxx
+ * macro is empty, and the module compiles to nothing, so a normal build pays nothing for it.
+ *
+ * Phases are timed as laps: PROFILE_START() sets a mark, and each PROFILE_LAP(phase) adds the time since the last
+ * mark to that phase, then moves the mark. Time is read from clock() on the F256 (jiffies) and from the monotonic
+ * clock on other systems.
+ *
+ * The lexer counters are kept by the C version of Lexer_Line(): with LEXER_ASM defined, they stay at 0.
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+
+// C includes
+#include <stdint.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+// phases of a conversion
+#define PROFILE_PHASE_READ			0		// line links and lines, from the read block, and refilling it
+#define PROFILE_PHASE_DECODE		1		// Lexer_Line(): tokens to items
+#define PROFILE_PHASE_EMIT			2		// back-ends: text, stats, cross-reference
+#define PROFILE_PHASE_WRITE			3		// the text, into the write block, and flushing it
+#define PROFILE_PHASE_ECHO			4		// printf() of the text to the screen
+#define PROFILE_NUM_PHASES			5
+
+#ifdef PROFILE
+	#define PROFILE_RESET()				Profile_Reset()
+	#define PROFILE_START()				Profile_Start()
+	#define PROFILE_LAP(the_phase)		Profile_Lap(the_phase)
+	#define PROFILE_COUNT(the_counter)	(++profile_counters.the_counter)
+	#define PROFILE_PRINT()				Profile_Print()
+#else
+	#define PROFILE_RESET()
+	#define PROFILE_START()
+	#define PROFILE_LAP(the_phase)
+	#define PROFILE_COUNT(the_counter)
+	#define PROFILE_PRINT()
+#endif
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+// hot-path events, counted with PROFILE_COUNT(name_)
+typedef struct ProfileCounters
+{
+	uint32_t			lines_;
+	uint32_t			basic2_keywords_;		// single-byte tokens 128-203
+	uint32_t			extension_keywords_;	// single-byte tokens 204-254 of the dialect's extension table
+	uint32_t			ce_prefixes_;			// CE-prefixed C128 tokens
+	uint32_t			fe_prefixes_;			// FE-prefixed C128 tokens
+	uint32_t			bad_tokens_;
+	uint32_t			string_chars_;			// bytes inside quotes
+	uint32_t			string_runs_;			// runs of identical bytes inside quotes, collapsed into one item
+	uint32_t			repeats_written_;		// runs written as {x*n}
+	uint32_t			block_reads_;			// fread() calls made by inconvert() to refill its read block
+	uint32_t			block_writes_;			// fwrite() calls made by inconvert() to flush its write block
+} ProfileCounters;
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+#ifdef PROFILE
+	extern ProfileCounters	profile_counters;
+#endif
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                          */
+/*****************************************************************************/
+
+#ifdef PROFILE
+
+//! Zero all phase times and counters
+void Profile_Reset(void);
+
+//! Set the mark the next lap is timed from
+void Profile_Start(void);
+
+//! Add the time since the mark to a phase, and move the mark to now
+//! @param	the_phase: PROFILE_PHASE_xxx
+void Profile_Lap(uint8_t the_phase);
+
+//! Print the time spent in each phase, and its share of the whole conversion, and the counters
+void Profile_Print(void);
+
+#endif
+
+#endif /* PROFILE_H */
@@ -0,0 +1,445 @@
+/*
+ * search.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+ 
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+
+// project includes
+#include "search.h"
+#include "detokenize.h"
+#include "lexer.h"
+#include "lineindex.h"
+#include "tokenize.h"
+#include "tokens.h"
+
+// C includes
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+// cc65 includes
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define CH_QUOTE				34
+#define TOKEN_PREFIX_CE			0xCE
+#define TOKEN_PREFIX_FE			0xFE
+#define SEARCH_MAX_KEYWORD_LEN	16		// longer than any keyword in tokens.c
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+// find the longest keyword of the dialect at the start of the_text, and write its 1 or 2 token bytes to the_bytes
+// returns the number of characters of the_text used, or 0 if no keyword matched
+uint8_t Search_MatchKeyword(char* the_text, basic_t mode, uint8_t* the_bytes, uint8_t* the_num_bytes);
+
+// find the PETSCII value of a {escape} name, such as "red" or "cm a"
+// returns -1 if there is no such escape
+int16_t Search_EscapeToPetscii(char* the_name, uint8_t the_len);
+
+// check whether a CE or FE byte at the_byte starts a 2-byte C128 token in this dialect (same rules as detokenize)
+bool Search_IsPrefixPair(const uint8_t* the_byte, basic_t mode);
+
+// check whether the pattern matches at the_byte. spaces in the program are skipped outside quotes.
+bool Search_MatchAt(SearchPattern* the_pattern, const uint8_t* the_byte, bool quotemode);
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+
+// find the longest keyword of the dialect at the start of the_text, and write its 1 or 2 token bytes to the_bytes
+// returns the number of characters of the_text used, or 0 if no keyword matched
+uint8_t Search_MatchKeyword(char* the_text, basic_t mode, uint8_t* the_bytes, uint8_t* the_num_bytes)
+{
+	char		the_upper[SEARCH_MAX_KEYWORD_LEN + 1];
+	int			the_token_len;
+	uint8_t		the_len;
+	uint8_t		i;
+	
+	// LOGIC:
+	//   keywords are looked up with tokenize's trie, so search and tokenize mode share one set of dialect rules.
+	//   the trie only knows upper case keywords, so just enough of the text to hold the longest one is upper cased first
+	
+	for (i = 0; i < SEARCH_MAX_KEYWORD_LEN && the_text[i] != '\0'; i++)
+	{
+		the_upper[i] = toupper(the_text[i]);
+	}
+	
+	the_upper[i] = '\0';
+	
+	the_len = tokenize_keyword(the_upper, mode, the_bytes, &the_token_len);
+	
+	if (the_len > 0)
+	{
+		*the_num_bytes = the_token_len;
+	}
+	
+	return the_len;
+}
+
+
+// find the PETSCII value of a {escape} name, such as "red" or "cm a"
+// returns -1 if there is no such escape
+int16_t Search_EscapeToPetscii(char* the_name, uint8_t the_len)
+{
+	int16_t		i;
+	
+	for (i = 0; i < 256; i++)
+	{
+		if (tokenmatch(tokentext(PetsciiNames, i), the_name, the_len))
+		{
+			return i;
+		}
+	}
+	
+	return -1;
+}
+
+
+// check whether a CE or FE byte at the_byte starts a 2-byte C128 token in this dialect (same rules as detokenize)
+bool Search_IsPrefixPair(const uint8_t* the_byte, basic_t mode)
+{
+	// LOGIC: the limits are the lexer's, so search pairs up exactly the bytes that detokenize lists as one keyword
+	
+	if (*the_byte == TOKEN_PREFIX_CE)
+	{
+		return (the_byte[1] >= 2 && the_byte[1] < lexer_ce_end[mode]);
+	}
+	
+	return (the_byte[1] >= 2 && the_byte[1] < lexer_fe_end[mode]);
+}
+
+
+// check whether the pattern matches at the_byte. spaces in the program are skipped outside quotes.
+bool Search_MatchAt(SearchPattern* the_pattern, const uint8_t* the_byte, bool quotemode)
+{
+	uint8_t		i = 0;
+	
+	while (i < the_pattern->len_)
+	{
+		if (*the_byte == '\0')
+		{
+			return false;
+		}
+		
+		if (quotemode == false && *the_byte == ' ' && i > 0)
+		{
+			++the_byte;
+			continue;
+		}
+		
+		if (*the_byte != the_pattern->bytes_[i])
+		{
+			return false;
+		}
+		
+		if (*the_byte == CH_QUOTE)
+		{
+			quotemode = !quotemode;
+		}
+		
+		++the_byte;
+		++i;
+	}
+	
+	return true;
+}
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+//! Translate search text into its tokenized form
+//! Text starting with a double quote is matched inside strings, and may contain {escapes} such as {red} or {cm a}.
+//! Otherwise, keywords (in any case) are tokenized, other letters are matched as BASIC stores them, and spaces are ignored.
+//! @param	the_pattern: valid pointer to the pattern to fill in
+//! @param	the_text: the search text, as it would appear in a detokenized listing
+//! @param	mode: BASIC dialect of the program(s) to be searched
+//! @return	Returns false if the text is empty, too long, or contains an unknown {escape}
+bool Search_CompilePattern(SearchPattern* the_pattern, char* the_text, basic_t mode)
+{
+	bool		quoted;
+	char*		the_end;
+	char*		the_limit;
+	int16_t		the_petscii;
+	uint8_t		the_token[2];
+	uint8_t		the_token_len;
+	uint8_t		the_text_len;
+	uint8_t		the_byte;
+	
+	the_pattern->len_ = 0;
+	the_pattern->mode_ = mode;
+	
+	// LOGIC:
+	//   a leading quote means "inside a string". it (and a closing quote at the end) are not part of the bytes matched.
+	//   a quote later in the text switches between command and quoted translation, as in PRINT"HELLO"
+	
+	the_limit = the_text + strlen(the_text);
+	
+	if (*the_text == '\"')
+	{
+		the_pattern->in_quotes_ = true;
+		++the_text;
+		
+		if (the_limit > the_text && *(the_limit - 1) == '\"')
+		{
+			--the_limit;
+		}
+	}
+	else
+	{
+		the_pattern->in_quotes_ = false;
+	}
+	
+	quoted = the_pattern->in_quotes_;
+	
+	while (the_text < the_limit)
+	{
+		the_token_len = 1;
+		
+		if (quoted)
+		{
+			if (*the_text == '{')
+			{
+				the_end = strchr(the_text, '}');
+				
+				if (the_end == NULL || the_end >= the_limit)
+				{
+					return false;
+				}
+				
+				the_petscii = Search_EscapeToPetscii(the_text + 1, the_end - the_text - 1);
+				
+				if (the_petscii < 0)
+				{
+					return false;
+				}
+				
+				the_token[0] = (uint8_t)the_petscii;
+				the_text = the_end + 1;
+			}
+			else
+			{
+				// in strings, unshifted letters are shown in lower case and shifted ones in upper case (see petscii in tokens.c)
+				the_byte = *the_text++;
+				
+				if (the_byte >= 'a' && the_byte <= 'z')
+				{
+					the_byte = the_byte - 'a' + 65;
+				}
+				else if (the_byte >= 'A' && the_byte <= 'Z')
+				{
+					the_byte = the_byte - 'A' + 193;
+				}
+				else if (the_byte == CH_QUOTE)
+				{
+					quoted = false;
+				}
+				
+				the_token[0] = the_byte;
+			}
+		}
+		else
+		{
+			if (*the_text == ' ')
+			{
+				++the_text;
+				continue;
+			}
+			
+			the_text_len = Search_MatchKeyword(the_text, mode, the_token, &the_token_len);
+			
+			if (the_text_len > 0)
+			{
+				the_text += the_text_len;
+			}
+			else
+			{
+				// outside strings, BASIC only has unshifted letters, shown in lower case by detokenize
+				the_byte = toupper(*the_text++);
+				
+				if (the_byte == CH_QUOTE)
+				{
+					quoted = true;
+				}
+				
+				the_token[0] = the_byte;
+			}
+		}
+		
+		if (the_pattern->len_ + the_token_len > SEARCH_MAX_PATTERN_LEN)
+		{
+			return false;
+		}
+		
+		memcpy(&the_pattern->bytes_[the_pattern->len_], the_token, the_token_len);
+		the_pattern->len_ += the_token_len;
+	}
+	
+	return (the_pattern->len_ > 0);
+}
+
+
+//! Check whether a tokenized line contains the pattern
+//! @param	the_pattern: valid pointer to a compiled pattern
+//! @param	the_line: tokenized line data, after the line number, null terminated
+//! @param	the_len: number of bytes in the_line, not including the terminator
+//! @return	Returns true if the pattern is found
+bool Search_LineMatches(SearchPattern* the_pattern, const uint8_t* the_line, uint8_t the_len)
+{
+	uint8_t		the_first = the_pattern->bytes_[0];
+	bool		quotemode = false;
+	bool		prefixed;
+	uint8_t		the_byte;
+	
+	// LOGIC:
+	//   most lines don't contain the first byte of the pattern at all, and memchr() rejects those at full speed.
+	//   only lines that do are walked byte by byte, to know whether each candidate is inside a string or not.
+	
+	if (memchr(the_line, the_first, the_len) == NULL)
+	{
+		return false;
+	}
+	
+	prefixed = (lexer_ce_end[the_pattern->mode_] > 0 || lexer_fe_end[the_pattern->mode_] > 0);
+	
+	while ( (the_byte = *the_line) != '\0')
+	{
+		if (the_byte == the_first && quotemode == the_pattern->in_quotes_ && Search_MatchAt(the_pattern, the_line, quotemode))
+		{
+			return true;
+		}
+		
+		if (the_byte == CH_QUOTE)
+		{
+			quotemode = !quotemode;
+		}
+		else if (quotemode == false && prefixed && (the_byte == TOKEN_PREFIX_CE || the_byte == TOKEN_PREFIX_FE) && Search_IsPrefixPair(the_line, the_pattern->mode_))
+		{
+			// second byte of a C128 token is not a character in its own right
+			++the_line;
+		}
+		
+		++the_line;
+	}
+	
+	return false;
+}
+
+
+//! Find the next line in an indexed program that contains the pattern
+//! @param	the_index: valid pointer to a LineIndex
+//! @param	the_pattern: valid pointer to a pattern compiled for the index's dialect
+//! @param	the_position: position in the index to start searching at (inclusive)
+//! @return	Returns the position of the matching line, or LINEINDEX_NOT_FOUND
+uint16_t Search_FindNext(LineIndex* the_index, SearchPattern* the_pattern, uint16_t the_position)
+{
+	uint8_t*	the_line;
+	uint16_t	the_offset;
+	uint16_t	the_line_addr;
+	uint16_t	nextadr;
+	
+	for (; the_position < the_index->num_lines_; the_position++)
+	{
+		// the line length comes from the link address: link (2) + line number (2) + data + terminator (1)
+		the_offset = the_index->entries_[the_position].offset_;
+		the_line = LineIndex_GetLine(the_index, the_position);
+		nextadr = the_line[0] | (the_line[1] << 8);
+		the_line_addr = the_index->start_addr_ + the_offset;
+		
+		if (nextadr - the_line_addr < 5)
+		{
+			continue;
+		}
+		
+		if (Search_LineMatches(the_pattern, the_line + 4, nextadr - the_line_addr - 5))
+		{
+			return the_position;
+		}
+	}
+	
+	return LINEINDEX_NOT_FOUND;
+}
+
+
+//! Search a program file, printing the line number of every matching line
+//! @param	the_filename: name of the tokenized BASIC program file
+//! @param	the_text: the search text (see Search_CompilePattern())
+//! @return	Returns the number of matching lines, or -1 if the file could not be read or the text could not be translated
+int16_t Search_File(char* the_filename, char* the_text)
+{
+	FILE*			the_file;
+	LineIndex*		the_index = NULL;
+	SearchPattern	the_pattern;
+	int16_t			addr_lo;
+	int16_t			addr_hi;
+	uint16_t		the_position = 0;
+	int16_t			the_count = 0;
+	clock_t			the_ticks;
+	
+	the_file = fopen(the_filename, "r");
+	
+	if (the_file == NULL)
+	{
+		return -1;
+	}
+	
+	addr_lo = fgetc(the_file);
+	addr_hi = fgetc(the_file);
+	
+	if (addr_lo >= 0 && addr_hi >= 0)
+	{
+		the_index = LineIndex_New(the_file, addr_lo + (addr_hi << 8), DETOKENIZE_FLAG_NONE);
+	}
+	
+	fclose(the_file);
+	
+	if (the_index == NULL)
+	{
+		return -1;
+	}
+	
+	// the pattern is translated for each file, as each may be a different dialect
+	if (Search_CompilePattern(&the_pattern, the_text, the_index->mode_) == false)
+	{
+		LineIndex_Destroy(&the_index);
+		return -1;
+	}
+	
+	the_ticks = clock();
+	
+	while ( (the_position = Search_FindNext(the_index, &the_pattern, the_position)) != LINEINDEX_NOT_FOUND)
+	{
+		printf("%u ", the_index->entries_[the_position].line_number_);
+		++the_count;
+		++the_position;
+	}
+	
+	the_ticks = clock() - the_ticks;
+	
+	printf("\n%s: %d matching lines of %u (%lu ticks) \n", the_filename, the_count, the_index->num_lines_, (unsigned long)the_ticks);
+	
+	LineIndex_Destroy(&the_index);
+	
+	return the_count;
+}
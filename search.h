@@ -0,0 +1,89 @@
+/*
+ * search.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+ 
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+/* about this module: Search
+ *
+ * Finds keywords, numbers, and strings in tokenized BASIC programs without detokenizing them.
+ * The search text is translated once into the bytes BASIC itself would have stored: keywords become their token
+ * (including CE/FE-prefixed C128 tokens), and quoted text becomes PETSCII. Lines are then matched byte for byte,
+ * tracking quote mode the same way detokenize() does, so a keyword pattern never matches inside a string, and a
+ * string pattern never matches outside one. Lines without the first byte of the pattern are rejected with memchr().
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "detokenize.h"
+#include "lineindex.h"
+
+// C includes
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define SEARCH_MAX_PATTERN_LEN		32
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct SearchPattern
+{
+	uint8_t			bytes_[SEARCH_MAX_PATTERN_LEN];	// tokenized/PETSCII form of the search text
+	uint8_t			len_;
+	bool			in_quotes_;		// true: only matches inside quoted strings. false: only matches outside them
+	basic_t			mode_;			// BASIC dialect the pattern was tokenized for
+} SearchPattern;
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                          */
+/*****************************************************************************/
+
+//! Translate search text into its tokenized form
+//! Text starting with a double quote is matched inside strings, and may contain {escapes} such as {red} or {cm a}.
+//! Otherwise, keywords (in any case) are tokenized, other letters are matched as BASIC stores them, and spaces are ignored.
+//! @param	the_pattern: valid pointer to the pattern to fill in
+//! @param	the_text: the search text, as it would appear in a detokenized listing
+//! @param	mode: BASIC dialect of the program(s) to be searched
+//! @return	Returns false if the text is empty, too long, or contains an unknown {escape}
+bool Search_CompilePattern(SearchPattern* the_pattern, char* the_text, basic_t mode);
+
+//! Check whether a tokenized line contains the pattern
+//! @param	the_pattern: valid pointer to a compiled pattern
+//! @param	the_line: tokenized line data, after the line number, null terminated
+//! @param	the_len: number of bytes in the_line, not including the terminator
+//! @return	Returns true if the pattern is found
+bool Search_LineMatches(SearchPattern* the_pattern, const uint8_t* the_line, uint8_t the_len);
+
+//! Find the next line in an indexed program that contains the pattern
+//! @param	the_index: valid pointer to a LineIndex
+//! @param	the_pattern: valid pointer to a pattern compiled for the index's dialect
+//! @param	the_position: position in the index to start searching at (inclusive)
+//! @return	Returns the position of the matching line, or LINEINDEX_NOT_FOUND
+uint16_t Search_FindNext(LineIndex* the_index, SearchPattern* the_pattern, uint16_t the_position);
+
+//! Search a program file, printing the line number of every matching line
+//! @param	the_filename: name of the tokenized BASIC program file
+//! @param	the_text: the search text (see Search_CompilePattern())
+//! @return	Returns the number of matching lines, or -1 if the file could not be read or the text could not be translated
+int16_t Search_File(char* the_filename, char* the_text);
+
+
+#endif /* SEARCH_H */
@@ -3,9 +3,48 @@
 
 
 #include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
 
 #include "select.h"
 #include "detokenize.h"
+#include "tokens.h"
+
+/* Dialects detection chooses between, smallest first. BASIC 4.0, 3.5 and
+ * VIC Super Expander are left out, as detokenize has no keywords for them.
+ */
+static const basic_t candidates[DETECT_NUM_CANDIDATES] = {
+	Basic2, TFC3, Graphics52, Basic7, Basic71
+};
+
+#define DETECT_MIN_EXTENSION_USES	2	/* extension keywords needed before a dialect is believed */
+#define DETECT_CLEAR_USES			32	/* extension keywords needed to stop early */
+#define DETECT_CLEAR_MARGIN			4	/* invalid tokens every other dialect needs to stop early */
+
+/* static because cc65 doesn't like creating that much on the stack */
+static unsigned char detect_buf[256];
+
+
+/* builtbasic
+ * - Gets the dialect a program is read as in this build: dialects left
+ *   out of it (see detokenize.h) are read as BASIC 2.0
+ * in:	mode - BASIC dialect
+ * out:	BASIC dialect
+ */
+static basic_t builtbasic(basic_t mode)
+{
+#ifdef NO_GRAPHICS52
+	if (Graphics52 == mode) return Basic2;
+#endif
+#ifdef NO_TFC3
+	if (TFC3 == mode) return Basic2;
+#endif
+#ifdef NO_BASIC7
+	if (Basic7 == mode || Basic71 == mode) return Basic2;
+#endif
+	return mode;
+}
 
 /* selectbasic
  * - Selects a BASIC dialect with regard to the starting address
@@ -30,11 +69,11 @@ basic_t selectbasic(int adr)
 	 */
 	switch (adr) {
 		case 0x0401:
-			return Graphics52;
+			return builtbasic(Graphics52);
 			break;
 
 		case 0x0801:
-			return TFC3;
+			return builtbasic(TFC3);
 			break;
 
 		case 0x1001:
@@ -44,17 +83,241 @@ basic_t selectbasic(int adr)
 
 		case 0x132D:
 		case 0x1C01:
-			return Basic71;
+			return builtbasic(Basic71);
 			break;
 
 		case 0x4001:
-			return Basic7;
+			return builtbasic(Basic7);
 			break;
 
 		default:
 			fprintf(stderr, "* Unrecognized start address of BASIC: %04x\n",
 			        adr);
-			return Basic71;
+			return builtbasic(Basic71);
 			break;
 	}
-}
\ No newline at end of file
+}
+
+
+/* basicname
+ * - Gets a readable name for a BASIC dialect
+ * in:	mode - BASIC dialect
+ * out:	name of the dialect
+ */
+const char *basicname(basic_t mode)
+{
+	switch (mode) {
+		case Basic2:		return "BASIC 2.0";
+		case Graphics52:	return "Graphics52";
+		case TFC3:			return "TFC3";
+		case Basic7:		return "BASIC 7.0";
+		case Basic71:		return "BASIC 7.1";
+		case Basic35:		return "BASIC 3.5";
+		case Basic4:		return "BASIC 4.0";
+		case VicSuper:		return "VIC Super Expander";
+		default:			return "any";
+	}
+}
+
+
+/* detect_init
+ * - Starts a dialect detection
+ * in:	state_p - detection state to clear
+ * out:	none
+ */
+void detect_init(detect_t *state_p)
+{
+	memset(state_p, 0, sizeof(detect_t));
+}
+
+
+/* detect_line
+ * - Adds the tokens of one line to a dialect detection. Only tokens in
+ *   command mode count: strings, and everything after REM, are skipped.
+ * in:	state_p - detection state
+ *		line_p - tokenized line, after the line number, null terminated
+ * out:	true if one dialect has clearly won, and no more lines are needed
+ */
+bool detect_line(detect_t *state_p, const unsigned char *line_p)
+{
+	int quotemode = false;		/* flag for quote mode */
+	unsigned char valid;		/* bit per candidate that has a keyword for the token */
+	unsigned char ch;			/* current byte */
+	int i;						/* candidate counter */
+	int best;					/* candidate in the lead */
+
+	state_p->lines ++;
+
+	while ((ch = *line_p) != 0) {
+		line_p ++;
+
+		if (34 == ch) {
+			quotemode = !quotemode;
+			continue;
+		} /* if */
+
+		if (quotemode || ch < 128 || 255 == ch) {
+			continue;
+		} /* if */
+
+		if (0x8F == ch) {		/* REM: rest of line is text */
+			break;
+		} /* if */
+
+		/* Candidates are Basic2, TFC3, Graphics52, Basic7, Basic71 */
+		if (ch <= 203) {
+			valid = 0x1F;
+		} /* if */
+		else if (0xFE == ch && *line_p >= 2 && *line_p <= 0x37) {
+			/* C128 FE prefix: 7.1 has more of these than 7.0 */
+			valid = (*line_p <= 0x26) ? 0x18 : 0x10;
+			line_p ++;
+		} /* else */
+		else if (0xCE == ch && *line_p >= 2 && *line_p < C128CETOKENS_COUNT) {
+			/* C128 CE prefix, or a single byte token elsewhere */
+			valid = 0x1E;
+			line_p ++;
+		} /* else */
+		else {
+			valid = 0;
+			if (ch - 204 < TFC3TOKENS_COUNT)		valid |= 0x02;
+			if (ch - 204 < GRAPHICS52TOKENS_COUNT)	valid |= 0x04;
+			if (ch - 204 < C128TOKENS_COUNT)		valid |= 0x18;
+		} /* else */
+
+		state_p->tokens ++;
+
+		for (i = 0; i < DETECT_NUM_CANDIDATES; i ++) {
+			if (valid & (1 << i)) {
+				if (ch > 203) {
+					state_p->extension[i] ++;
+				} /* if */
+			} /* if */
+			else {
+				state_p->invalid[i] ++;
+			} /* else */
+		} /* for */
+	} /* while */
+
+	/* A dialect has clearly won once it explains every token, with plenty
+	 * of extension keywords, and every other dialect has several tokens
+	 * it can't explain. 7.0 and 7.1 are never told apart this way: 7.1
+	 * explains everything 7.0 does.
+	 */
+	best = -1;
+	for (i = 0; i < DETECT_NUM_CANDIDATES; i ++) {
+		if (0 == state_p->invalid[i] &&
+		    state_p->extension[i] >= DETECT_CLEAR_USES &&
+		    builtbasic(candidates[i]) == candidates[i]) {
+			best = i;
+			break;
+		} /* if */
+	} /* for */
+
+	if (best < 0) {
+		return false;
+	} /* if */
+
+	for (i = 0; i < DETECT_NUM_CANDIDATES; i ++) {
+		if (i != best &&
+		    !(candidates[i] >= Basic7 && candidates[best] >= Basic7) &&
+		    state_p->invalid[i] < DETECT_CLEAR_MARGIN) {
+			return false;
+		} /* if */
+	} /* for */
+
+	return true;
+}
+
+
+/* detect_result
+ * - Chooses the dialect that explains the most tokens seen. A dialect is
+ *   only believed if it has at least a couple of its own keywords, so a
+ *   stray byte doesn't turn a BASIC 2.0 program into an extension one.
+ *   Ties go to the dialect the start address suggests, then to the
+ *   smallest one.
+ * in:	state_p - detection state
+ *		adr - starting address
+ *		confidence_p - set to the percentage of tokens the chosen
+ *		               dialect has keywords for (may be NULL)
+ * out:	BASIC dialect
+ */
+basic_t detect_result(const detect_t *state_p, int adr, int *confidence_p)
+{
+	basic_t guess;				/* dialect from the start address */
+	int best = 0;				/* chosen candidate; BASIC 2.0 is always allowed */
+	int i;						/* candidate counter */
+	unsigned min_uses;			/* extension keywords needed for a candidate */
+
+	guess = selectbasic(adr);
+
+	if (0 == state_p->tokens) {
+		if (confidence_p) *confidence_p = 0;
+		return guess;
+	} /* if */
+
+	for (i = 1; i < DETECT_NUM_CANDIDATES; i ++) {
+		min_uses = (candidates[i] == guess) ? 1 : DETECT_MIN_EXTENSION_USES;
+
+		if (state_p->extension[i] < min_uses ||
+		    builtbasic(candidates[i]) != candidates[i]) {
+			continue;
+		} /* if */
+
+		if (state_p->invalid[i] < state_p->invalid[best] ||
+		    (state_p->invalid[i] == state_p->invalid[best] &&
+		     candidates[i] == guess)) {
+			best = i;
+		} /* if */
+	} /* for */
+
+	if (confidence_p) {
+		*confidence_p = (int) (((uint32_t) (state_p->tokens - state_p->invalid[best]) * 100) / state_p->tokens);
+	} /* if */
+
+	return candidates[best];
+}
+
+
+/* detectbasic
+ * - Detects the BASIC dialect of a program from the tokens it uses,
+ *   following the line links until the end of the program, or until one
+ *   dialect has clearly won. Nothing is detokenized.
+ * in:	input - open file, positioned just after the start address
+ *		adr - starting address
+ *		confidence_p - set to the percentage of tokens the chosen
+ *		               dialect has keywords for (may be NULL)
+ * out:	BASIC dialect
+ */
+basic_t detectbasic(FILE *input, int adr, int *confidence_p)
+{
+	detect_t state;				/* detection state */
+	unsigned addr = adr;		/* address of current line */
+	unsigned nextadr;			/* address of next line */
+	int lo, hi;					/* bytes of the link address */
+
+	detect_init(&state);
+
+	while ((lo = fgetc(input)) >= 0 && (hi = fgetc(input)) >= 0) {
+		nextadr = lo | (hi << 8);
+
+		/* Same link checks as the converter */
+		if (0 == nextadr || nextadr <= addr || nextadr - addr >= 256) {
+			break;
+		} /* if */
+
+		if (fread(detect_buf, 1, nextadr - addr - 2, input) != nextadr - addr - 2) {
+			break;
+		} /* if */
+
+		detect_buf[nextadr - addr - 2] = 0;
+		addr = nextadr;
+
+		/* skip the line number */
+		if (detect_line(&state, detect_buf + 2)) {
+			break;
+		} /* if */
+	} /* while */
+
+	return detect_result(&state, adr, confidence_p);
+}
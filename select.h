@@ -2,9 +2,28 @@
 #define SELECT_H
 
 
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include "detokenize.h"
 
+/* number of dialects detectbasic() chooses between */
+#define DETECT_NUM_CANDIDATES	5
+
+/* state of a dialect detection, built up one line at a time */
+typedef struct detect_s {
+	uint16_t	invalid[DETECT_NUM_CANDIDATES];		/* tokens each candidate has no keyword for */
+	uint16_t	extension[DETECT_NUM_CANDIDATES];	/* tokens past BASIC 2.0 each candidate has a keyword for */
+	uint16_t	tokens;								/* all tokens seen */
+	uint16_t	lines;								/* lines looked at */
+} detect_t;
+
 basic_t selectbasic(int adr);
+const char *basicname(basic_t mode);
+void detect_init(detect_t *state_p);
+bool detect_line(detect_t *state_p, const unsigned char *line_p);
+basic_t detect_result(const detect_t *state_p, int adr, int *confidence_p);
+basic_t detectbasic(FILE *input, int adr, int *confidence_p);
 
 
 #endif /* SELECT_H */
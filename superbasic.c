@@ -0,0 +1,313 @@
+/*
+ * superbasic.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+
+// project includes
+#include "superbasic.h"
+#include "detokenize.h"
+#include "lexer.h"
+#include "tokens.h"
+
+// C includes
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// cc65 includes
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define CH_COLON					58
+#define TOKEN_DATA					0x83
+#define TOKEN_REM					0x8F
+
+
+/*****************************************************************************/
+/*                          File-Scope Variables                             */
+/*****************************************************************************/
+
+// SuperBASIC spelling of each BASIC 2.0 token, 128-203. NULL where there is no direct equivalent.
+static const char*	superbasic_keywords[C64TOKENS_COUNT] =
+{
+	"end",				/* 128 */	/* 0x80 */
+	"for",
+	"next",				/* 130 */
+	"data",
+	NULL,				// INPUT#: no files
+	"input",
+	"dim",
+	"read",
+	"let",
+	"goto",
+	"run",
+	"if",
+	"restore",			/* 140 */
+	"gosub",
+	"return",
+	"rem",
+	"stop",							/* 0x90 */
+	NULL,				// ON
+	NULL,				// WAIT
+	NULL,				// LOAD
+	NULL,				// SAVE
+	NULL,				// VERIFY
+	NULL,				/* 150 */	// DEF
+	"poke",
+	NULL,				// PRINT#
+	"print",
+	NULL,				// CONT
+	NULL,				// LIST
+	NULL,				// CLR
+	NULL,				// CMD
+	NULL,				// SYS: C64 addresses mean nothing on the F256
+	NULL,				// OPEN
+	NULL,				/* 160 */	/* 0xA0 */	// CLOSE
+	NULL,				// GET
+	NULL,				// NEW
+	NULL,				// TAB(
+	"to",
+	NULL,				// FN
+	NULL,				// SPC(
+	"then",
+	"not",
+	"step",
+	"+",				/* 170 */	/* 0xAA */
+	"-",
+	"*",
+	"/",
+	NULL,				// ^: exclusive or in SuperBASIC, not power
+	"and",
+	"or",
+	">",
+	"=",
+	"<",
+	"sgn(",				/* 180 */	/* 0xB4 */
+	"int(",
+	"abs(",
+	NULL,				// USR(
+	NULL,				// FRE(
+	NULL,				// POS(
+	"sqr(",
+	"rnd(",
+	NULL,				// LOG(
+	NULL,				// EXP(
+	"cos(",				/* 190 */
+	"sin(",
+	"tan(",
+	NULL,				// ATN(
+	"peek(",
+	"len(",
+	"str$(",
+	"val(",
+	"asc(",
+	"chr$(",
+	"left$(",			/* 200 */
+	"right$(",
+	"mid$(",
+	NULL,				// GO
+};
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+// check whether a character written next to a keyword would run into it, and need a space between
+bool SuperBasic_IsNameChar(char the_char);
+
+// write the translation of one item to output_p, adding a space before it if it would run into the text before it
+// returns the number of characters written, or -1 if the item has no SuperBASIC equivalent
+int16_t SuperBasic_ItemText(LexerItem* the_item, char* output_p, bool in_data, bool after_keyword);
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+
+// check whether a character written next to a keyword would run into it, and need a space between
+bool SuperBasic_IsNameChar(char the_char)
+{
+	return (isalnum((unsigned char)the_char) || the_char == '$' || the_char == '%' || the_char == '.');
+}
+
+
+// write the translation of one item to output_p, adding a space before it if it would run into the text before it
+// returns the number of characters written, or -1 if the item has no SuperBASIC equivalent
+int16_t SuperBasic_ItemText(LexerItem* the_item, char* output_p, bool in_data, bool after_keyword)
+{
+	char*			the_start = output_p;
+	uint8_t			the_char = the_item->value_;
+	uint8_t			the_run = the_item->run_;
+	const char*		the_keyword;
+	bool			is_keyword = false;
+	char			the_first;
+	
+	switch (the_item->kind_)
+	{
+		case LEXER_KIND_KEYWORD:
+			if (the_char >= 128 + C64TOKENS_COUNT || superbasic_keywords[the_char - 128] == NULL)
+			{
+				return -1;
+			}
+			
+			the_keyword = superbasic_keywords[the_char - 128];
+			the_first = the_keyword[0];
+			is_keyword = true;
+			break;
+			
+		case LEXER_KIND_QUOTE:
+			the_first = '\"';
+			break;
+			
+		case LEXER_KIND_CHAR:
+			// unquoted text in DATA is read as a string by CBM BASIC; SuperBASIC would need quotes, so it can't be kept
+			if (the_char >= 65 && the_char <= 90)
+			{
+				if (in_data)
+				{
+					return -1;
+				}
+				
+				the_first = tolower(the_char);
+			}
+			else if (the_char >= 32 && the_char <= 64)
+			{
+				the_first = the_char;
+			}
+			else
+			{
+				return -1;
+			}
+			break;
+			
+		case LEXER_KIND_STRING:
+			// in CBM BASIC's normal character set, 65-90 show as capital letters, and 32-64, [ and ] as in ASCII.
+			// anything else is a control or graphics character, with no ASCII equivalent.
+			if (the_char < 32 || the_char > 93 || the_char == 92)
+			{
+				return -1;
+			}
+			
+			the_first = the_char;
+			break;
+			
+		default:
+			// C128 prefixed keywords, and tokens with no keyword in this dialect
+			return -1;
+	}
+	
+	// FORI=1TO9 and GOTO100 are fine in CBM BASIC, but SuperBASIC would read FORI and GOTO100 as names.
+	// there is always at least the line number and a space before output_p.
+	if ((is_keyword || after_keyword) && SuperBasic_IsNameChar(output_p[-1]) && SuperBasic_IsNameChar(the_first))
+	{
+		*(output_p++) = ' ';
+	}
+	
+	if (is_keyword)
+	{
+		while (*the_keyword)
+		{
+			*(output_p++) = *(the_keyword++);
+		}
+	}
+	else
+	{
+		while (the_run--)
+		{
+			*(output_p++) = the_first;
+		}
+	}
+	
+	return output_p - the_start;
+}
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+//! Back-end: the line as SuperBASIC source, followed by a newline. the_context: SuperBasicText*
+void SuperBasic_BackEnd(LexerLine* the_line, void* the_context)
+{
+	SuperBasicText*	the_text = (SuperBasicText*)the_context;
+	char*			output_p = the_text->buffer_;
+	LexerItem*		the_item = the_line->items_;
+	uint16_t		i;
+	int16_t			the_len;
+	bool			in_data = false;
+	bool			after_keyword = false;
+
+	output_p += sprintf(output_p, "%u ", the_line->line_number_);
+
+	for (i = 0; i < the_line->num_items_; i++, the_item++)
+	{
+		// the rest of a REM is a comment in both, so it is kept as it lists
+		if (the_item->kind_ == LEXER_KIND_KEYWORD && the_item->value_ == TOKEN_REM)
+		{
+			output_p += SuperBasic_ItemText(the_item, output_p, false, after_keyword);
+
+			if (i + 1 < the_line->num_items_ && (the_item[1].kind_ != LEXER_KIND_CHAR || the_item[1].value_ != ' '))
+			{
+				*(output_p++) = ' ';
+			}
+
+			while (++i < the_line->num_items_)
+			{
+				output_p += Lexer_ItemText(the_line, ++the_item, output_p, DETOKENIZE_FLAG_NONE);
+			}
+			break;
+		}
+
+		if (the_item->kind_ == LEXER_KIND_KEYWORD && the_item->value_ == TOKEN_DATA)
+		{
+			in_data = true;
+		}
+		else if (the_item->kind_ == LEXER_KIND_CHAR && the_item->value_ == CH_COLON)
+		{
+			in_data = false;
+		}
+
+		the_len = SuperBasic_ItemText(the_item, output_p, in_data, after_keyword);
+
+		if (the_len < 0)
+		{
+			// LOGIC:
+			//   the line can't be translated. it is written as a REM with its CBM listing, rather than translating
+			//   part of it: a statement left out could change what the rest of the line does.
+			output_p = the_text->buffer_ + sprintf(the_text->buffer_, "%u rem ", the_line->line_number_);
+
+			for (i = 0, the_item = the_line->items_; i < the_line->num_items_; i++)
+			{
+				output_p += Lexer_ItemText(the_line, the_item++, output_p, DETOKENIZE_FLAG_NONE);
+			}
+
+			++the_text->rem_lines_;
+			break;
+		}
+
+		output_p += the_len;
+		after_keyword = (the_item->kind_ == LEXER_KIND_KEYWORD);
+	}
+
+	*output_p++ = '\n';
+	*output_p = 0;
+
+	the_text->len_ = output_p - the_text->buffer_;
+}
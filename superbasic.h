@@ -0,0 +1,63 @@
+/*
+ * superbasic.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+#ifndef SUPERBASIC_H
+#define SUPERBASIC_H
+
+/* about this module: SuperBasic
+ *
+ * Writes a decoded line as F256 SuperBASIC source, instead of as a CBM listing. It is a lexer back-end (see lexer.h),
+ * so it works from the same keyword table walk as the text converter.
+ *
+ * Keywords that SuperBASIC has a direct equivalent for are written in its spelling (all lower case, with spaces kept
+ * between keywords and names, since SuperBASIC names can be longer than 2 characters). Variable names are written in
+ * lower case, and string characters as the ASCII characters they show as.
+ *
+ * A line that can't be translated this way (a keyword with no equivalent, such as ON, GET, DEF FN, or any BASIC
+ * extension keyword; a control or graphics character in a string; or unquoted text in DATA) is written as a REM,
+ * followed by its CBM listing, so nothing is lost and the lines left to port by hand are easy to find.
+ *
+ * SuperBASIC stores programs as text, and tokenizes them as they are loaded: its tokens refer to the identifier table
+ * it builds in memory, so there is no tokenized program file format to write to instead.
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lexer.h"
+
+// C includes
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+// context for SuperBasic_BackEnd()
+typedef struct SuperBasicText
+{
+	char*				buffer_;			// must be big enough for the line (see detokenize())
+	uint16_t			len_;				// length written, including the newline
+	uint16_t			rem_lines_;			// lines that could not be translated, and were written as REMs. zero it before the first line.
+} SuperBasicText;
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                          */
+/*****************************************************************************/
+
+//! Back-end: the line as SuperBASIC source, followed by a newline. the_context: SuperBasicText*
+void SuperBasic_BackEnd(LexerLine* the_line, void* the_context);
+
+
+#endif /* SUPERBASIC_H */
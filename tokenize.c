@@ -0,0 +1,501 @@
+/* tokenize.c
+ * - routines to tokenize C64/C128 BASIC text, in the format detokenize
+ *   writes, back into binary lines
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tokenize.h"
+#include "tokens.h"
+#include "lexer.h"
+
+#define TOKEN_DATA				0x83
+#define TOKEN_REM				0x8F
+#define LOWER_KEYWORD_MAX		16	/* longer than any keyword in tokens.c */
+
+
+/* Keyword trie node. Keywords are stored one character per node: a node's
+ * children continue the keywords that start with the characters on the
+ * path to it, and siblings are the other characters possible at the same
+ * position. Node 0 is not used, so 0 can mean "none".
+ */
+typedef struct trienode_s {
+	unsigned short child;		/* first node for the next character, 0 if none */
+	unsigned short sibling;		/* next node at this position, 0 if none */
+	unsigned char ch;			/* character matched by this node */
+	unsigned char prefix;		/* 0, or 0xCE/0xFE for a 2-byte C128 token */
+	unsigned char token;		/* token byte if a keyword ends here, else 0 */
+} trienode_t;
+
+static trienode_t *trie_p = NULL;			/* node pool */
+static unsigned short trie_size = 0;		/* nodes allocated in the pool */
+static unsigned short trie_used = 0;		/* nodes in use, including unused node 0 */
+static unsigned short trie_root[128];		/* first node for each ASCII character */
+static basic_t trie_mode = Any;				/* dialect the trie was built for */
+
+static unsigned char text_to_petscii[128];	/* PETSCII byte for each single character escape */
+static unsigned char font_to_petscii[128];	/* PETSCII byte for each PETSCII font code 128-255 */
+static bool maps_ready = false;
+
+int tokenize_lowercase = false;				/* see tokenize.h */
+
+
+/* trie_add
+ * - adds a keyword to the trie. If the keyword is already there (from a
+ *   table added before), the first one is kept.
+ * in:	keyword_p - keyword, upper case ASCII, packed (see tokens.h)
+ *		prefix - 0, or 0xCE/0xFE for a 2-byte C128 token
+ *		token - token byte
+ * out:	none
+ */
+static void trie_add(const unsigned char *keyword_p, unsigned char prefix, unsigned char token)
+{
+	unsigned short *link_p;		/* link to follow or fill in */
+	unsigned short node = 0;	/* current node */
+	unsigned char ch;			/* current keyword character */
+
+	if (TOKEN_END_BIT == *keyword_p) {
+		return;
+	} /* if */
+
+	link_p = &trie_root[*keyword_p & ~TOKEN_END_BIT];
+
+	do {
+		ch = *keyword_p & ~TOKEN_END_BIT;
+
+		/* Look for this character among the nodes at this position */
+		while (*link_p && trie_p[*link_p].ch != ch) {
+			link_p = &trie_p[*link_p].sibling;
+		} /* while */
+
+		if (0 == *link_p) {
+			node = trie_used ++;
+			memset(&trie_p[node], 0, sizeof(trienode_t));
+			trie_p[node].ch = ch;
+			*link_p = node;
+		} /* if */
+
+		node = *link_p;
+		link_p = &trie_p[node].child;
+	} while (0 == (*(keyword_p ++) & TOKEN_END_BIT));
+
+	if (0 == trie_p[node].token) {
+		trie_p[node].prefix = prefix;
+		trie_p[node].token = token;
+	} /* if */
+}
+
+
+/* trie_build
+ * - builds the keyword trie for a dialect from the tokens.c tables: the
+ *   same tables, and the same token ranges (the lexer's keyword limits),
+ *   detokenize uses
+ * in:	mode - BASIC dialect
+ * out:	false if memory could not be allocated
+ */
+static bool trie_build(basic_t mode)
+{
+	tokentable_t ext_table = C64Tokens;	/* extension table for dialect */
+	int ext_count;				/* entries in extension table */
+	int fe_count;				/* FE entries valid in dialect */
+	int ce_count;				/* CE entries valid in dialect */
+	unsigned short need = 1;	/* nodes needed, at most: one per character */
+	int i;						/* loop counter */
+
+#ifdef TOKENS_FILE
+	Lexer_LoadTables(mode);
+#endif
+
+	/* Dialects left out of the build (see detokenize.h) have no keywords
+	 * past BASIC 2.0, so their programs are tokenized as BASIC 2.0.
+	 */
+	ext_count = lexer_extension_count[mode];
+	ce_count = lexer_ce_end[mode];
+	fe_count = lexer_fe_end[mode];
+
+	if (Basic7 == mode || Basic71 == mode) {
+		ext_table = C128Tokens;
+	} /* if */
+	else if (Graphics52 == mode) {
+		ext_table = Graphics52Tokens;
+	} /* else */
+	else if (TFC3 == mode) {
+		ext_table = TFC3Tokens;
+	} /* else */
+
+	for (i = 0; i < C64TOKENS_COUNT; i ++) need += tokenlen(tokentext(C64Tokens, i));
+	for (i = 0; i < ext_count; i ++) need += tokenlen(tokentext(ext_table, i));
+	for (i = 2; i < ce_count; i ++) need += tokenlen(tokentext(C128CETokens, i));
+	for (i = 2; i < fe_count; i ++) need += tokenlen(tokentext(C128FETokens, i));
+
+	if (need > trie_size) {
+		free(trie_p);
+		trie_p = (trienode_t *) malloc(need * sizeof(trienode_t));
+		trie_size = need;
+
+		if (NULL == trie_p) {
+			trie_size = 0;
+			trie_mode = Any;
+			return false;
+		} /* if */
+	} /* if */
+
+	memset(trie_root, 0, sizeof(trie_root));
+	trie_used = 1;
+
+	/* C64 BASIC 2.0 first, so it wins over extensions with the same word */
+	for (i = 0; i < C64TOKENS_COUNT; i ++) trie_add(tokentext(C64Tokens, i), 0, 128 + i);
+	for (i = 0; i < ext_count; i ++) trie_add(tokentext(ext_table, i), 0, 204 + i);
+	for (i = 2; i < ce_count; i ++) trie_add(tokentext(C128CETokens, i), 0xCE, i);
+	for (i = 2; i < fe_count; i ++) trie_add(tokentext(C128FETokens, i), 0xFE, i);
+
+	trie_mode = mode;
+
+	return true;
+}
+
+
+/* trie_match
+ * - finds the longest keyword at the start of the text
+ * in:	text_p - text to match
+ *		token_p - where to write the 1 or 2 token bytes
+ *		toklen_p - where to write the number of token bytes
+ * out:	number of characters of text matched, 0 if no keyword
+ */
+static int trie_match(const char *text_p, unsigned char *token_p, int *toklen_p)
+{
+	unsigned short node;		/* current node */
+	unsigned short best = 0;	/* node of longest keyword so far */
+	int len = 0;				/* characters matched so far */
+	int bestlen = 0;			/* length of longest keyword so far */
+	unsigned char ch = *text_p;	/* current character */
+
+	if (ch >= 128) {
+		return 0;
+	} /* if */
+
+	node = trie_root[ch];
+
+	while (node) {
+		len ++;
+
+		if (trie_p[node].token) {
+			best = node;
+			bestlen = len;
+		} /* if */
+
+		ch = text_p[len];
+
+		for (node = trie_p[node].child; node && trie_p[node].ch != ch; node = trie_p[node].sibling) {
+		} /* for */
+	} /* while */
+
+	if (bestlen) {
+		if (trie_p[best].prefix) {
+			token_p[0] = trie_p[best].prefix;
+			token_p[1] = trie_p[best].token;
+			*toklen_p = 2;
+		} /* if */
+		else {
+			token_p[0] = trie_p[best].token;
+			*toklen_p = 1;
+		} /* else */
+	} /* if */
+
+	return bestlen;
+}
+
+
+/* lower_keyword
+ * - checks for a keyword typed in lower case, which tokenize keeps as
+ *   letters: the lower case letters at the start of the text, and a '$'
+ *   or '(' after them, are matched as if they were upper case
+ * in:	text_p - text to check, starting with a lower case letter
+ * out:	TRUE / FALSE
+ */
+static int lower_keyword(const unsigned char *text_p)
+{
+	char upper[LOWER_KEYWORD_MAX + 2];	/* text in upper case */
+	unsigned char token[2];		/* matched keyword, not used */
+	int toklen;					/* bytes in token, not used */
+	int i;						/* character counter */
+
+	for (i = 0; i < LOWER_KEYWORD_MAX && text_p[i] >= 'a' && text_p[i] <= 'z'; i ++) {
+		upper[i] = text_p[i] - 'a' + 'A';
+	} /* for */
+
+	if ('$' == text_p[i] || '(' == text_p[i]) {
+		upper[i] = text_p[i];
+		i ++;
+	} /* if */
+
+	upper[i] = 0;
+
+	return (trie_match(upper, token, &toklen) > 0);
+}
+
+
+/* maps_build
+ * - builds the reverse maps for characters inside quotes: the single
+ *   character PETSCII names, and the PETSCII font codes. Where more
+ *   than one PETSCII byte shows as the same character, the lowest is used.
+ * in:	none
+ * out:	none
+ */
+static void maps_build(void)
+{
+	int i;						/* loop counter */
+	unsigned char ch;			/* character or font code */
+	const unsigned char *name_p;	/* packed PETSCII name */
+
+	for (i = 255; i >= 0; i --) {
+		name_p = tokentext(PetsciiNames, i);
+		if (1 == tokenlen(name_p)) {
+			text_to_petscii[name_p[0] & ~TOKEN_END_BIT] = i;
+		} /* if */
+
+		ch = petscii_font[i];
+		if (ch >= 128) {
+			font_to_petscii[ch - 128] = i;
+		} /* if */
+	} /* for */
+
+	maps_ready = true;
+}
+
+
+/* escape_value
+ * - finds the PETSCII byte for the name inside an {escape}
+ * in:	name_p - start of the name
+ *		len - length of the name
+ * out:	PETSCII byte, or -1 if the name is not known
+ */
+static int escape_value(const char *name_p, int len)
+{
+	int i;						/* loop counter */
+	int value = 0;				/* numeric escape */
+
+	if (5 == len && 0 == strncmp(name_p, "space", 5)) {
+		return 32;
+	} /* if */
+
+	for (i = 0; i < 256; i ++) {
+		if (tokenmatch(tokentext(PetsciiNames, i), name_p, len)) {
+			return i;
+		} /* if */
+	} /* for */
+
+	/* Bytes with no name, and tokens with no keyword, are written as
+	 * their number
+	 */
+	if (0 == len || len > 3) {
+		return -1;
+	} /* if */
+
+	for (i = 0; i < len; i ++) {
+		if (name_p[i] < '0' || name_p[i] > '9') {
+			return -1;
+		} /* if */
+		value = value * 10 + name_p[i] - '0';
+	} /* for */
+
+	return (value <= 255) ? value : -1;
+}
+
+
+/* The text used in the function (input) is one line of a listing, in the
+ * format detokenize writes: line number, a space, then the line, with
+ * keywords in upper case, unshifted letters in lower case, and other
+ * characters as {escapes}. The output is the line number (low, high),
+ * then the tokenized line, null terminated: what detokenize takes.
+ */
+
+/* tokenize
+ * - tokenize a line of C64/C128 BASIC text
+ * in:	input_p - text line, ending in a newline or null
+ *		output_p - buffer for the tokenized line, at least 256 bytes
+ *		mode - BASIC version to tokenize for
+ * out:	length of the tokenized line including line number and null,
+ *		or -1 if the line could not be tokenized
+ */
+int tokenize(const char *input_p, unsigned char *output_p, basic_t mode)
+{
+	int quotemode = false;			/* flag for quote mode */
+	const unsigned char *ch_p;		/* pointer moving over input */
+	const unsigned char *end_p;		/* end of an {escape} */
+	const unsigned char *star_p;	/* '*' of a {x*n} repetition */
+	unsigned char *out_p;			/* pointer moving over output */
+	unsigned char *limit_p;			/* end of room for line data */
+	unsigned long linenumber = 0;	/* line number */
+	unsigned char token[2];			/* matched keyword */
+	int toklen;						/* bytes in token */
+	int matched;					/* characters of keyword matched */
+	int value;						/* PETSCII byte */
+	int count;						/* repetitions */
+	int literal = 0;				/* 1 after DATA (to the next ':'), 2 after REM */
+
+	tokenize_lowercase = false;
+
+	if (trie_mode != mode && !trie_build(mode)) {
+		return -1;
+	} /* if */
+
+	if (!maps_ready) {
+		maps_build();
+	} /* if */
+
+	ch_p = (const unsigned char *) input_p;
+
+	/* Line number, then the one space detokenize writes after it */
+	if (*ch_p < '0' || *ch_p > '9') {
+		return -1;
+	} /* if */
+
+	while (*ch_p >= '0' && *ch_p <= '9') {
+		linenumber = linenumber * 10 + *(ch_p ++) - '0';
+		if (linenumber > 0xFFFF) {
+			return -1;
+		} /* if */
+	} /* while */
+
+	if (' ' == *ch_p) {
+		ch_p ++;
+	} /* if */
+
+	output_p[0] = linenumber & 0xFF;
+	output_p[1] = linenumber >> 8;
+	out_p = output_p + 2;
+	limit_p = out_p + TOKENIZE_MAX_DATA_LEN;
+
+	while (*ch_p && '\n' != *ch_p && '\r' != *ch_p) {
+		/* Escapes, possibly repeated: {name} or {name*n} */
+		if ('{' == *ch_p) {
+			end_p = (const unsigned char *) strchr((const char *) ch_p, '}');
+			if (NULL == end_p) {
+				return -1;
+			} /* if */
+
+			count = 1;
+			for (star_p = end_p - 1; star_p > ch_p + 1 && *star_p >= '0' && *star_p <= '9'; star_p --) {
+			} /* for */
+
+			if ('*' == *star_p && star_p > ch_p + 1 && star_p < end_p - 1) {
+				count = atoi((const char *) star_p + 1);
+			} /* if */
+			else {
+				star_p = end_p;
+			} /* else */
+
+			value = escape_value((const char *) ch_p + 1, star_p - ch_p - 1);
+			if (value < 0 || out_p + count > limit_p) {
+				return -1;
+			} /* if */
+
+			while (count --) {
+				*(out_p ++) = value;
+			} /* while */
+
+			ch_p = end_p + 1;
+			continue;
+		} /* if */
+
+		if (out_p >= limit_p) {
+			return -1;
+		} /* if */
+
+		if (quotemode) {
+			/* Unshifted letters are lower case, shifted upper case, and
+			 * bytes 128-255 are PETSCII font codes
+			 */
+			if ('\"' == *ch_p) {
+				quotemode = false;
+				value = 34;
+			} /* if */
+			else if (*ch_p >= 128) {
+				value = font_to_petscii[*ch_p - 128];
+			} /* else */
+			else {
+				value = text_to_petscii[*ch_p];
+			} /* else */
+
+			/* Characters with no PETSCII equivalent are kept as they are */
+			*(out_p ++) = value ? value : *ch_p;
+			ch_p ++;
+		} /* if */
+		else {
+			/* Keywords are upper case, and always tokenized */
+			matched = trie_match((const char *) ch_p, token, &toklen);
+
+			if (matched) {
+				if (out_p + toklen > limit_p) {
+					return -1;
+				} /* if */
+
+				memcpy(out_p, token, toklen);
+				out_p += toklen;
+				ch_p += matched;
+
+				if (TOKEN_REM == token[0] && 1 == toklen) {
+					literal = 2;
+				} /* if */
+				else if (TOKEN_DATA == token[0] && 1 == toklen && !literal) {
+					literal = 1;
+				} /* else */
+			} /* if */
+			else {
+				if ('\"' == *ch_p) {
+					quotemode = true;		/* go to quotemode */
+				} /* if */
+				else if (':' == *ch_p && 1 == literal) {
+					literal = 0;
+				} /* else */
+
+				/* Text is written in lower case, but stored unshifted. A
+				 * whole keyword in lower case can't have come from the
+				 * BASIC editor, except after REM or in DATA, so it is
+				 * reported.
+				 */
+				if (*ch_p >= 'a' && *ch_p <= 'z') {
+					if (!literal && !(ch_p[-1] >= 'a' && ch_p[-1] <= 'z') && lower_keyword(ch_p)) {
+						tokenize_lowercase = true;
+					} /* if */
+					*(out_p ++) = *ch_p - 'a' + 'A';
+				} /* if */
+				else {
+					*(out_p ++) = *ch_p;
+				} /* else */
+
+				ch_p ++;
+			} /* else */
+		} /* else */
+	} /* while */
+
+	*(out_p ++) = 0;
+
+	return (out_p - output_p);
+}
+
+
+/* tokenize_keyword
+ * - finds the longest keyword of a dialect at the start of the text,
+ *   with the same tables and token ranges tokenize uses
+ * in:	text_p - text to match, keywords in upper case
+ *		mode - BASIC version to match keywords of
+ *		token_p - where to write the 1 or 2 token bytes
+ *		toklen_p - where to write the number of token bytes
+ * out:	number of characters of text matched, 0 if no keyword
+ *		(or if there was no memory for the keyword trie)
+ */
+int tokenize_keyword(const char *text_p, basic_t mode, unsigned char *token_p, int *toklen_p)
+{
+	/* Searches can come before any line is tokenized, so the trie may not
+	 * have been built yet even when trie_mode is Any
+	 */
+	if ((trie_mode != mode || NULL == trie_p) && !trie_build(mode)) {
+		return 0;
+	} /* if */
+
+	return trie_match(text_p, token_p, toklen_p);
+}
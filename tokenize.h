@@ -0,0 +1,21 @@
+#ifndef TOKENIZE_H
+#define TOKENIZE_H
+
+#include <stdint.h>
+#include "detokenize.h"
+
+/* longest tokenized line: link (2) + line number (2) + data + null must
+ * stay below 256 bytes, the limit the converter checks links against
+ */
+#define TOKENIZE_MAX_DATA_LEN	250
+
+int tokenize(const char *input_p, unsigned char *output_p, basic_t mode);
+int tokenize_keyword(const char *text_p, basic_t mode, unsigned char *token_p, int *toklen_p);
+
+/* set by tokenize when the line has a keyword in lower case outside quotes
+ * (and not after REM or in DATA). It is kept as letters, as keywords are
+ * only recognized in upper case, as the converter writes them.
+ */
+extern int tokenize_lowercase;
+
+#endif /* TOKENIZE_H */
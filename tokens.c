@@ -1,267 +1,290 @@
 /* tokens.c
  * - contains a list of C64 BASIC and C128 BASIC tokens
- *   as well as a PETSCII table
+ *   as well as a PETSCII table, packed, and their index
  */
 
+#include <stddef.h>
+#ifdef TOKENS_FILE
+#include <stdio.h>
+#endif
+
 #include "tokens.h"
 
+/* Tables are written as the CBM ROM writes its keyword list: the last
+ * character of each string has bit 7 set (see tokens.h).
+ */
+#define LAST(ch)			((ch) | TOKEN_END_BIT)
+#define EMPTY				TOKEN_END_BIT
+
+#define TOKEN_MAX_PAGES		4	/* 256-byte pages the largest table (petscii) spans */
+
 /* C64/VIC20 BASIC 2.0 (base for all versions)
  * offset: 128
  */
 
-const char *c64tokens[] = {
+static const unsigned char c64tokens[] = {
 	/* instructions */
-	"END",				/* 128 */	/* 0x80 */
-	"FOR",
-	"NEXT",				/* 130 */
-	"DATA",
-	"INPUT#",
-	"INPUT",
-	"DIM",
-	"READ",
-	"LET",
-	"GOTO",
-	"RUN",
-	"IF",
-	"RESTORE",			/* 140 */
-	"GOSUB",
-	"RETURN",
-	"REM",
-	"STOP",							/* 0x90 */
-	"ON",
-	"WAIT",
-	"LOAD",
-	"SAVE",
-	"VERIFY",
-	"DEF",				/* 150 */
-	"POKE",
-	"PRINT#",
-	"PRINT",
-	"CONT",
-	"LIST",
-	"CLR",
-	"CMD",
-	"SYS",
-	"OPEN",
-	"CLOSE",			/* 160 */	/* 0xA0 */
-	"GET",
-	"NEW",
-	"TAB(",
-	"TO",
-	"FN",
-	"SPC(",
-	"THEN",
-	"NOT",
-	"STEP",
+	'E','N',LAST('D'),		/* 128 */	/* 0x80 */
+	'F','O',LAST('R'),
+	'N','E','X',LAST('T'),	/* 130 */
+	'D','A','T',LAST('A'),
+	'I','N','P','U','T',LAST('#'),
+	'I','N','P','U',LAST('T'),
+	'D','I',LAST('M'),
+	'R','E','A',LAST('D'),
+	'L','E',LAST('T'),
+	'G','O','T',LAST('O'),
+	'R','U',LAST('N'),
+	'I',LAST('F'),
+	'R','E','S','T','O','R',LAST('E'),	/* 140 */
+	'G','O','S','U',LAST('B'),
+	'R','E','T','U','R',LAST('N'),
+	'R','E',LAST('M'),
+	'S','T','O',LAST('P'),	/* 0x90 */
+	'O',LAST('N'),
+	'W','A','I',LAST('T'),
+	'L','O','A',LAST('D'),
+	'S','A','V',LAST('E'),
+	'V','E','R','I','F',LAST('Y'),
+	'D','E',LAST('F'),		/* 150 */
+	'P','O','K',LAST('E'),
+	'P','R','I','N','T',LAST('#'),
+	'P','R','I','N',LAST('T'),
+	'C','O','N',LAST('T'),
+	'L','I','S',LAST('T'),
+	'C','L',LAST('R'),
+	'C','M',LAST('D'),
+	'S','Y',LAST('S'),
+	'O','P','E',LAST('N'),
+	'C','L','O','S',LAST('E'),	/* 160 */	/* 0xA0 */
+	'G','E',LAST('T'),
+	'N','E',LAST('W'),
+	'T','A','B',LAST('('),
+	'T',LAST('O'),
+	'F',LAST('N'),
+	'S','P','C',LAST('('),
+	'T','H','E',LAST('N'),
+	'N','O',LAST('T'),
+	'S','T','E',LAST('P'),
 
 	/* mathematical functions */
-	"+",				/* 170 */	/* 0xAA */
-	"-",
-	"*",
-	"/",
-	"^", /* (arrow up) */
-	"AND",
-	"OR",							/* 0xB0 */
-	">",
-	"=",
-	"<",
+	LAST('+'),				/* 170 */	/* 0xAA */
+	LAST('-'),
+	LAST('*'),
+	LAST('/'),
+	LAST('^'),				/* (arrow up) */
+	'A','N',LAST('D'),
+	'O',LAST('R'),			/* 0xB0 */
+	LAST('>'),
+	LAST('='),
+	LAST('<'),
 
 	/* unary functions */
-	"SGN",				/* 180 */	/* 0xB4 */
-	"INT",
-	"ABS",
-	"USR",
-	"FRE",
-	"POS",
-	"SQR",
-	"RND",
-	"LOG",
-	"EXP",
-	"COS",				/* 190 */
-	"SIN",
-	"TAN",							/* 0xC0 */
-	"ATN",
-	"PEEK",
-	"LEN",
-	"STR$",
-	"VAL",
-	"ASC",
-	"CHR$",
+	'S','G',LAST('N'),		/* 180 */	/* 0xB4 */
+	'I','N',LAST('T'),
+	'A','B',LAST('S'),
+	'U','S',LAST('R'),
+	'F','R',LAST('E'),
+	'P','O',LAST('S'),
+	'S','Q',LAST('R'),
+	'R','N',LAST('D'),
+	'L','O',LAST('G'),
+	'E','X',LAST('P'),
+	'C','O',LAST('S'),		/* 190 */
+	'S','I',LAST('N'),
+	'T','A',LAST('N'),		/* 0xC0 */
+	'A','T',LAST('N'),
+	'P','E','E',LAST('K'),
+	'L','E',LAST('N'),
+	'S','T','R',LAST('$'),
+	'V','A',LAST('L'),
+	'A','S',LAST('C'),
+	'C','H','R',LAST('$'),
 
 	/* functions with more than one parameter */
-	"LEFT$",			/* 200 */	/* 0xC8 */
-	"RIGHT$",
-	"MID$",
+	'L','E','F','T',LAST('$'),	/* 200 */	/* 0xC8 */
+	'R','I','G','H','T',LAST('$'),
+	'M','I','D',LAST('$'),
 	
 	/* special */
-	"GO" /*("GO TO")*/	/* 203 */	/* 0xCB */
+	'G',LAST('O'),			/*("GO TO")*/	/* 203 */	/* 0xCB */
 };
 
+/* With TOKENS_FILE, the extension tables are not built in, but loaded
+ * from TOKEN_FILENAME when they are first used (see tokenload).
+ */
+#ifndef TOKENS_FILE
+
+#ifndef NO_GRAPHICS52
 /* C64 Graphics52 BASIC extension (Software Unlimited)
  * offset: 204
  */
 
-const char *graphics52tokens[] = {
-	"SCREEN",			/* 204 */	/* 0xCC */
-	"SPRCL",
-	"PLOT",
-	"DRAW",
-	"CLEAR",						/* 0xD0 */
-	"TOGL",
-	"ERASE",			/* 210 */
-	"CHAR",
-	"SMOVE",
-	"COLOR",
-	"SPRITE",
-	"SPROG",
-	"CPROG",
-	"PEN",
-	"FLIP",
-	"TRANSFER",
-	"BLOCK",			/* 220 */
-	"BOTTOM",
-	"SDP",
-	"SCRSV",
-	"LOSCR",						/* 0xE0 */
-	"LOSPR",
-	"LOCHR",
-	"SPRSV",
-	"CHRSV",
-	"SMOOTH",
-	"VOLUME",			/* 230 */
-	"ADSR",
-	"SHIFT",
-	"PITCH",
-	"WAVE",
-	"PULSE",
-	"DETECT",
-	"PUT",
-	"MOVE",
-	"PLACE",			/* 240 */	/* 0xF0 */
-	"COPY",
-	"MEMSV",
-	"LOMEM",
-	"SWAP",
-	"BRD&BKG",
-	"SWITCH",
-	"UNLESS",
-	"MULTI",
-	"SHRINK",
-	"PADL(",			/* 250 */
-	"JOY(",
-	"BIT(",
-	"LOC(",
-	"POINT("
+static const unsigned char graphics52tokens[] = {
+	'S','C','R','E','E',LAST('N'),	/* 204 */	/* 0xCC */
+	'S','P','R','C',LAST('L'),
+	'P','L','O',LAST('T'),
+	'D','R','A',LAST('W'),
+	'C','L','E','A',LAST('R'),	/* 0xD0 */
+	'T','O','G',LAST('L'),
+	'E','R','A','S',LAST('E'),	/* 210 */
+	'C','H','A',LAST('R'),
+	'S','M','O','V',LAST('E'),
+	'C','O','L','O',LAST('R'),
+	'S','P','R','I','T',LAST('E'),
+	'S','P','R','O',LAST('G'),
+	'C','P','R','O',LAST('G'),
+	'P','E',LAST('N'),
+	'F','L','I',LAST('P'),
+	'T','R','A','N','S','F','E',LAST('R'),
+	'B','L','O','C',LAST('K'),	/* 220 */
+	'B','O','T','T','O',LAST('M'),
+	'S','D',LAST('P'),
+	'S','C','R','S',LAST('V'),
+	'L','O','S','C',LAST('R'),	/* 0xE0 */
+	'L','O','S','P',LAST('R'),
+	'L','O','C','H',LAST('R'),
+	'S','P','R','S',LAST('V'),
+	'C','H','R','S',LAST('V'),
+	'S','M','O','O','T',LAST('H'),
+	'V','O','L','U','M',LAST('E'),	/* 230 */
+	'A','D','S',LAST('R'),
+	'S','H','I','F',LAST('T'),
+	'P','I','T','C',LAST('H'),
+	'W','A','V',LAST('E'),
+	'P','U','L','S',LAST('E'),
+	'D','E','T','E','C',LAST('T'),
+	'P','U',LAST('T'),
+	'M','O','V',LAST('E'),
+	'P','L','A','C',LAST('E'),	/* 240 */	/* 0xF0 */
+	'C','O','P',LAST('Y'),
+	'M','E','M','S',LAST('V'),
+	'L','O','M','E',LAST('M'),
+	'S','W','A',LAST('P'),
+	'B','R','D','&','B','K',LAST('G'),
+	'S','W','I','T','C',LAST('H'),
+	'U','N','L','E','S',LAST('S'),
+	'M','U','L','T',LAST('I'),
+	'S','H','R','I','N',LAST('K'),
+	'P','A','D','L',LAST('('),	/* 250 */
+	'J','O','Y',LAST('('),
+	'B','I','T',LAST('('),
+	'L','O','C',LAST('('),
+	'P','O','I','N','T',LAST('('),
 };
+#endif
 
+#ifndef NO_TFC3
 /* C64 TFC3 BASIC extension (Riska BV)
  * offset: 204
  */
 
-const char *tfc3tokens[] = {
-	"OFF",				/* 204 */	/* 0xCC */
-	"AUTO",
-	"DEL",
-	"RENUM",
-	"HELP",							/* 0xD0 */
-	"FIND",
-	"OLD",				/* 210 */
-	"DLOAD",
-	"DVERIFY",
-	"DSAVE",
-	"APPEND",
-	"DAPPEND",
-	"DOS",
-	"KILL",
-	"MON",
-	"PDIR",
-	"PLIST",			/* 220 */
-	"BAR",
-	"DESKTOP",
-	"DUMP",
-	"ARRAY",						/* 0xE0 */
-	"MEM",
-	"TRACE",
-	"REPLACE",
-	"ORDER",
-	"PACK",
-	"UNPACK",			/* 230 */
-	"MREAD",
-	"MWRITE"
+static const unsigned char tfc3tokens[] = {
+	'O','F',LAST('F'),		/* 204 */	/* 0xCC */
+	'A','U','T',LAST('O'),
+	'D','E',LAST('L'),
+	'R','E','N','U',LAST('M'),
+	'H','E','L',LAST('P'),	/* 0xD0 */
+	'F','I','N',LAST('D'),
+	'O','L',LAST('D'),		/* 210 */
+	'D','L','O','A',LAST('D'),
+	'D','V','E','R','I','F',LAST('Y'),
+	'D','S','A','V',LAST('E'),
+	'A','P','P','E','N',LAST('D'),
+	'D','A','P','P','E','N',LAST('D'),
+	'D','O',LAST('S'),
+	'K','I','L',LAST('L'),
+	'M','O',LAST('N'),
+	'P','D','I',LAST('R'),
+	'P','L','I','S',LAST('T'),	/* 220 */
+	'B','A',LAST('R'),
+	'D','E','S','K','T','O',LAST('P'),
+	'D','U','M',LAST('P'),
+	'A','R','R','A',LAST('Y'),	/* 0xE0 */
+	'M','E',LAST('M'),
+	'T','R','A','C',LAST('E'),
+	'R','E','P','L','A','C',LAST('E'),
+	'O','R','D','E',LAST('R'),
+	'P','A','C',LAST('K'),
+	'U','N','P','A','C',LAST('K'),	/* 230 */
+	'M','R','E','A',LAST('D'),
+	'M','W','R','I','T',LAST('E'),
 };
+#endif
  
+#ifndef NO_BASIC7
 /* C128 BASIC 7.0 and C16/+4 BASIC 3.5
  * offset: 204
  */
 
-const char *c128tokens[] = {
-	"RGR",				/* 204 */	/* 0xCC */
-	"RCLR",
-	"RLUM", /* (prefix in 7.0) */
-	"JOY",
-	"RDOT",							/* 0xD0 */
-	"DEC",
-	"HEX$",				/* 210 */
-	"ERR$",
-	"INSTR",
-	"ELSE",
-	"RESUME",
-	"TRAP",
-	"TRON",
-	"TROFF",
-	"SOUND",
-	"VOL",
-	"AUTO",				/* 220 */
-	"PUDEF",
-	"GRAPHIC",
-	"PAINT",
-	"CHAR",							/* 0xE0 */
-	"BOX",
-	"CIRCLE",
-	"GSHAPE",
-	"SSHAPE",
-	"DRAW",
-	"LOCATE",			/* 230 */
-	"COLOR",
-	"SCNCLR",
-	"SCALE",
-	"HELP",
-	"DO",
-	"LOOP",
-	"EXIT",
-	"DIRECTORY",
-	"DSAVE",
-	"DLOAD",			/* 240 */	/* 0xF0 */
-	"HEADER",
-	"SCRATCH",
-	"COLLECT",
-	"COPY",
-	"RENAME",
-	"BACKUP",
-	"DELETE",
-	"RENUMBER",
-	"KEY",
-	"MONITOR",			/* 250 */
-	"USING",
-	"UNTIL",
-	"WHILE"				/* 253 */	/* 0xFD */
+static const unsigned char c128tokens[] = {
+	'R','G',LAST('R'),		/* 204 */	/* 0xCC */
+	'R','C','L',LAST('R'),
+	'R','L','U',LAST('M'),	/* (prefix in 7.0) */
+	'J','O',LAST('Y'),
+	'R','D','O',LAST('T'),	/* 0xD0 */
+	'D','E',LAST('C'),
+	'H','E','X',LAST('$'),	/* 210 */
+	'E','R','R',LAST('$'),
+	'I','N','S','T',LAST('R'),
+	'E','L','S',LAST('E'),
+	'R','E','S','U','M',LAST('E'),
+	'T','R','A',LAST('P'),
+	'T','R','O',LAST('N'),
+	'T','R','O','F',LAST('F'),
+	'S','O','U','N',LAST('D'),
+	'V','O',LAST('L'),
+	'A','U','T',LAST('O'),	/* 220 */
+	'P','U','D','E',LAST('F'),
+	'G','R','A','P','H','I',LAST('C'),
+	'P','A','I','N',LAST('T'),
+	'C','H','A',LAST('R'),	/* 0xE0 */
+	'B','O',LAST('X'),
+	'C','I','R','C','L',LAST('E'),
+	'G','S','H','A','P',LAST('E'),
+	'S','S','H','A','P',LAST('E'),
+	'D','R','A',LAST('W'),
+	'L','O','C','A','T',LAST('E'),	/* 230 */
+	'C','O','L','O',LAST('R'),
+	'S','C','N','C','L',LAST('R'),
+	'S','C','A','L',LAST('E'),
+	'H','E','L',LAST('P'),
+	'D',LAST('O'),
+	'L','O','O',LAST('P'),
+	'E','X','I',LAST('T'),
+	'D','I','R','E','C','T','O','R',LAST('Y'),
+	'D','S','A','V',LAST('E'),
+	'D','L','O','A',LAST('D'),	/* 240 */	/* 0xF0 */
+	'H','E','A','D','E',LAST('R'),
+	'S','C','R','A','T','C',LAST('H'),
+	'C','O','L','L','E','C',LAST('T'),
+	'C','O','P',LAST('Y'),
+	'R','E','N','A','M',LAST('E'),
+	'B','A','C','K','U',LAST('P'),
+	'D','E','L','E','T',LAST('E'),
+	'R','E','N','U','M','B','E',LAST('R'),
+	'K','E',LAST('Y'),
+	'M','O','N','I','T','O',LAST('R'),	/* 250 */
+	'U','S','I','N',LAST('G'),
+	'U','N','T','I',LAST('L'),
+	'W','H','I','L',LAST('E'),	/* 253 */	/* 0xFD */
 };
 
 /* C128 BASIC 7.0
  * CE prefix - sprite commands
  */
 
-const char *c128CEtokens[] = {
-	"",					/* 0 */		/* 0x0 */
-	"",
-	"POT",
-	"BUMP",
-	"PEN",
-	"RSPOS",
-	"RSPRITE",
-	"RSPCOLOR",
-	"XOR",
-	"RWINDOW"			/* 9 */		/* 0x9 */
+static const unsigned char c128CEtokens[] = {
+	EMPTY,					/* 0 */		/* 0x0 */
+	EMPTY,
+	'P','O',LAST('T'),
+	'B','U','M',LAST('P'),
+	'P','E',LAST('N'),
+	'R','S','P','O',LAST('S'),
+	'R','S','P','R','I','T',LAST('E'),
+	'R','S','P','C','O','L','O',LAST('R'),
+	'X','O',LAST('R'),
+	'R','W','I','N','D','O',LAST('W'),	/* 9 */		/* 0x9 */
 };
 
 /* C128 BASIC 7.0
@@ -269,384 +292,793 @@ const char *c128CEtokens[] = {
  * includes Rick Simon's BASIC 7.1
  */
 
-const char *c128FEtokens[] = {
-	"",					/* 0 */		/* 0x0 */
-	"",
-	"BANK",
-	"FILTER",
-	"PLAY",
-	"TEMPO",
-	"MOVSPR",
-	"SPRITE",
-	"SPRCOLOR",
-	"RREG",
-	"ENVELOPE",			/* 10 */
-	"SLEEP",
-	"CATALOG",
-	"DOPEN",
-	"APPEND",
-	"DCLOSE",
-	"BSAVE",						/* 0x10 */
-	"BLOAD",
-	"RECORD",
-	"CONCAT",
-	"DVERIFY",			/* 20 */
-	"DCLEAR",
-	"SPRSAV",
-	"COLLISION",
-	"BEGIN",
-	"BEND",
-	"WINDOW",
-	"BOOT",
-	"WIDTH",
-	"SPRDEF",
-	"QUIT",				/* 30 */
-	"STASH",
-	"", /* (space) */				/* 0x20 */
-	"FETCH",
-	"", /* (quote) */
-	"SWAP",
-	"OFF",
-	"FAST",
-	"SLOW",				/* 38 */	/* 0x26 */
+static const unsigned char c128FEtokens[] = {
+	EMPTY,					/* 0 */		/* 0x0 */
+	EMPTY,
+	'B','A','N',LAST('K'),
+	'F','I','L','T','E',LAST('R'),
+	'P','L','A',LAST('Y'),
+	'T','E','M','P',LAST('O'),
+	'M','O','V','S','P',LAST('R'),
+	'S','P','R','I','T',LAST('E'),
+	'S','P','R','C','O','L','O',LAST('R'),
+	'R','R','E',LAST('G'),
+	'E','N','V','E','L','O','P',LAST('E'),	/* 10 */
+	'S','L','E','E',LAST('P'),
+	'C','A','T','A','L','O',LAST('G'),
+	'D','O','P','E',LAST('N'),
+	'A','P','P','E','N',LAST('D'),
+	'D','C','L','O','S',LAST('E'),
+	'B','S','A','V',LAST('E'),	/* 0x10 */
+	'B','L','O','A',LAST('D'),
+	'R','E','C','O','R',LAST('D'),
+	'C','O','N','C','A',LAST('T'),
+	'D','V','E','R','I','F',LAST('Y'),	/* 20 */
+	'D','C','L','E','A',LAST('R'),
+	'S','P','R','S','A',LAST('V'),
+	'C','O','L','L','I','S','I','O',LAST('N'),
+	'B','E','G','I',LAST('N'),
+	'B','E','N',LAST('D'),
+	'W','I','N','D','O',LAST('W'),
+	'B','O','O',LAST('T'),
+	'W','I','D','T',LAST('H'),
+	'S','P','R','D','E',LAST('F'),
+	'Q','U','I',LAST('T'),	/* 30 */
+	'S','T','A','S',LAST('H'),
+	EMPTY,					/* (space) */				/* 0x20 */
+	'F','E','T','C',LAST('H'),
+	EMPTY,					/* (quote) */
+	'S','W','A',LAST('P'),
+	'O','F',LAST('F'),
+	'F','A','S',LAST('T'),
+	'S','L','O',LAST('W'),	/* 38 */	/* 0x26 */
 	/* Rick Simon's BASIC 7.1 extension */
-	"CWIND",			/* 39 */	/* 0x27 */
-	"SSCRN",			/* 40 */
-	"LSCRN",
-	"HIDE",
-	"SHOW",
-	"SFONT",
-	"LFONT",
-	"VIEW",
-	"FCOPY",
-	"ESAVE",						/* 0x30 */
-	"SEND",
-	"CHECK",			/* 50 */
-	"ESC",
-	"OLD",
-	"FIND",
-	"DUMP",
-	"MERGE"				/* 55 */	/* 0x37 */
+	'C','W','I','N',LAST('D'),	/* 39 */	/* 0x27 */
+	'S','S','C','R',LAST('N'),	/* 40 */
+	'L','S','C','R',LAST('N'),
+	'H','I','D',LAST('E'),
+	'S','H','O',LAST('W'),
+	'S','F','O','N',LAST('T'),
+	'L','F','O','N',LAST('T'),
+	'V','I','E',LAST('W'),
+	'F','C','O','P',LAST('Y'),
+	'E','S','A','V',LAST('E'),	/* 0x30 */
+	'S','E','N',LAST('D'),
+	'C','H','E','C',LAST('K'),	/* 50 */
+	'E','S',LAST('C'),
+	'O','L',LAST('D'),
+	'F','I','N',LAST('D'),
+	'D','U','M',LAST('P'),
+	'M','E','R','G',LAST('E'),	/* 55 */	/* 0x37 */
 };
+#endif
 
+#ifdef WITH_BASIC4
 /* PET BASIC 4.0
  * includes C64 BASIC 4.0 extension
  * offset: 204
  */
-const char *basic4tokens[] = {
-	"CONCAT",			/* 204 */	/* 0xCC */
-	"DOPEN",
-	"DCLOSE",
-	"RECORD",
-	"HEADER",						/* 0xD0 */
-	"COLLECT",
-	"BACKUP",			/* 210 */
-	"COPY",
-	"APPEND",
-	"DSAVE",
-	"DLOAD",
-	"CATALOG",
-	"RENAME",
-	"SCRATCH",
-	"DIRECTORY",		/* 218 */	/* 0xDA */
+static const unsigned char basic4tokens[] = {
+	'C','O','N','C','A',LAST('T'),	/* 204 */	/* 0xCC */
+	'D','O','P','E',LAST('N'),
+	'D','C','L','O','S',LAST('E'),
+	'R','E','C','O','R',LAST('D'),
+	'H','E','A','D','E',LAST('R'),	/* 0xD0 */
+	'C','O','L','L','E','C',LAST('T'),
+	'B','A','C','K','U',LAST('P'),	/* 210 */
+	'C','O','P',LAST('Y'),
+	'A','P','P','E','N',LAST('D'),
+	'D','S','A','V',LAST('E'),
+	'D','L','O','A',LAST('D'),
+	'C','A','T','A','L','O',LAST('G'),
+	'R','E','N','A','M',LAST('E'),
+	'S','C','R','A','T','C',LAST('H'),
+	'D','I','R','E','C','T','O','R',LAST('Y'),	/* 218 */	/* 0xDA */
 	/* C64 BASIC 4.0 extension */
-	"COLOR",			/* 219 */	/* 0xDB */
-	"COLD",				/* 220 */
-	"KEY",
-	"DVERIFY",
-	"DELETE",
-	"AUTO",							/* 0xE0 */
-	"MERGE",
-	"OLD",
-	"MONITOR"			/* 227 */	/* 0xE3 */
+	'C','O','L','O',LAST('R'),	/* 219 */	/* 0xDB */
+	'C','O','L',LAST('D'),	/* 220 */
+	'K','E',LAST('Y'),
+	'D','V','E','R','I','F',LAST('Y'),
+	'D','E','L','E','T',LAST('E'),
+	'A','U','T',LAST('O'),	/* 0xE0 */
+	'M','E','R','G',LAST('E'),
+	'O','L',LAST('D'),
+	'M','O','N','I','T','O',LAST('R'),	/* 227 */	/* 0xE3 */
 };
+#endif
 
+#ifdef WITH_VICSUPER
 /* VIC Super Expander
  * offset: 204
  */
-const char *supertokens[] = {
-	"KEY",				/* 204 */	/* 0xCC */
-	"GRAPHIC",
-	"SCNCLR",
-	"CIRCLE",
-	"DRAW",							/* 0xD0 */
-	"REGION",
-	"COLOR",			/* 210 */
-	"POINT",
-	"SOUND",
-	"CHAR",
-	"PAINT",
-	"RPOT",
-	"RPEN",
-	"RSND",
-	"RCOLR",
-	"RGR",
-	"RJOY",				/* 220 */
-	"RDOT"				/* 221 */	/* 0xDD */
+static const unsigned char supertokens[] = {
+	'K','E',LAST('Y'),		/* 204 */	/* 0xCC */
+	'G','R','A','P','H','I',LAST('C'),
+	'S','C','N','C','L',LAST('R'),
+	'C','I','R','C','L',LAST('E'),
+	'D','R','A',LAST('W'),	/* 0xD0 */
+	'R','E','G','I','O',LAST('N'),
+	'C','O','L','O',LAST('R'),	/* 210 */
+	'P','O','I','N',LAST('T'),
+	'S','O','U','N',LAST('D'),
+	'C','H','A',LAST('R'),
+	'P','A','I','N',LAST('T'),
+	'R','P','O',LAST('T'),
+	'R','P','E',LAST('N'),
+	'R','S','N',LAST('D'),
+	'R','C','O','L',LAST('R'),
+	'R','G',LAST('R'),
+	'R','J','O',LAST('Y'),	/* 220 */
+	'R','D','O',LAST('T'),	/* 221 */	/* 0xDD */
 };
+#endif
+
+#endif /* TOKENS_FILE */
 
 /* petscii conversion tables
  * singlebyte => characters
  * multibyte => escape sequences (written as {sequence} in the text format)
  */
 
-const char *petscii[] = {
-	"null",				/* 0 */		/* 0x0 */
-	"ct a",
-	"ct b",
-	"ct c",
-	"ct d",
-	"white",
-	"ct f",
-	"ct g",
-	"ct h", /* (disable charset switch (C64)) */
-	"ct i", /* (enable charset switch (C64)) */
-	"ct j",				/* 10 */
-	"ct k",
-	"ct l",
-	"return",
-	"ct n",
-	"ct o",
-	"ct p",							/* 0x10 */
-	"down",
-	"reverse on",
-	"home",
-	"delete",			/* 20 */
-	"ct u",
-	"ct v",
-	"ct w",
-	"ct x",
-	"ct y",
-	"ct z",
-	"027", /* (c128) */
-	"red",
-	"right",
-	"green",			/* 30 */
-	"blue",
-	" ", /* (space) */				/* 0x20 */
-	"!",
-	"\"",
-	"#",
-	"$",
-	"%",
-	"&",
-	"'",
-	"(",				/* 40 */
-	")",
-	"*",
-	"+",
-	",",
-	"-",
-	".",
-	"/",
-	"0",							/* 0x30 */
-	"1",
-	"2",				/* 50 */
-	"3",
-	"4",
-	"5",
-	"6",
-	"7",
-	"8",
-	"9",
-	":",
-	";",
-	"<",				/* 60 */
-	"=",
-	">",
-	"?",
-	"@",							/* 0x40 */
-	"a",
-	"b",
-	"c",
-	"d",
-	"e",
-	"f",				/* 70 */
-	"g",
-	"h",
-	"i",
-	"j",
-	"k",
-	"l",
-	"m",
-	"n",
-	"o",
-	"p",				/* 80 */	/* 0x50 */
-	"q",
-	"r",
-	"s",
-	"t",
-	"u",
-	"v",
-	"w",
-	"x",
-	"y",
-	"z",				/* 90 */
-	"[",
-	"pound", /* pound */
-	"]",
-	"^",
-	"arrow left", /* <- */
-	"096",							/* 0x60 */
-	"097",
-	"098",
-	"099",
-	"100",				/* 100 */
-	"101",
-	"102",
-	"103",
-	"104",
-	"105",
-	"106",
-	"107",
-	"108",
-	"109",
-	"110",				/* 110 */
-	"111",
-	"112",							/* 0x70 */
-	"113",
-	"114",
-	"115",
-	"116",
-	"117",
-	"118",
-	"119",
-	"120",				/* 120 */
-	"121",
-	"122",
-	"123",
-	"124",
-	"125",
-	"126",
-	"127",
-	"128",							/* 0x80 */
-	"orange",
-	"130",				/* 130 */
-	"131",
-	"132",
-	"f1",
-	"f3",
-	"f5",
-	"f7",
-	"f2",
-	"f4",
-	"f6",
-	"f8",				/* 140 */
-	"141",
-	"142",
-	"143",
-	"black",						/* 0x90 */
-	"up",
-	"reverse off",
-	"clear",
-	"148", /* insert */
-	"brown",
-	"pink",				/* 150 */
-	"dark gray",
-	"gray",
-	"light green",
-	"light blue",
-	"light gray",
-	"156", /* run */
-	"left",
-	"yellow",
-	"cyan",
-	"sh space",			/* 160 */	/* 0xA0 */
-	"cm k",
-	"cm i",
-	"cm t",
-	"cm @",
-	"cm g",
-	"cm +",
-	"cm m",
-	"cm pound",
-	"sh pound",
-	"cm n",				/* 170 */
-	"cm q",
-	"cm d",
-	"cm z",
-	"cm s",
-	"cm p",
-	"cm a",							/* 0xB0 */
-	"cm e",
-	"cm r",
-	"cm w",
-	"cm h",				/* 180 */
-	"cm j",
-	"cm l",
-	"cm y",
-	"cm u",
-	"cm d",
-	"sh @",
-	"cm f",
-	"cm c",
-	"cm x",
-	"cm v",				/* 190 */
-	"cm b",
-	"sh asterisk",					/* 0xC0 */
-	"A",
-	"B",
-	"C",
-	"D",
-	"E",
-	"F",
-	"G",
-	"H",				/* 200 */
-	"I",
-	"J",
-	"K",
-	"L",
-	"M",
-	"N",
-	"O",
-	"P",								/* 0xD0 */
-	"Q",
-	"R",				/* 210 */
-	"S",
-	"T",
-	"U",
-	"V",
-	"W",
-	"X",
-	"Y",
-	"Z",
-	"sh +",
-	"cm -",				/* 220 */
-	"sh -",
-	"222",
-	"cm asterisk",
-	"224",								/* 0xE0 */
-	"225",
-	"226",
-	"227",
-	"228",
-	"229",
-	"230",				/* 230 */
-	"231",
-	"232",
-	"233",
-	"234",
-	"235",
-	"236",
-	"237",
-	"238",
-	"239",
-	"240",				/* 240 */		/* 0xF0 */
-	"241",
-	"242",
-	"243",
-	"244",
-	"245",
-	"246",
-	"247",
-	"248",
-	"249",
-	"250",				/* 250 */
-	"251",
-	"252",
-	"253",
-	"254",
-	"pi",				/* 255 */		/* 0xFF */
+static const unsigned char petscii[] = {
+	'n','u','l',LAST('l'),	/* 0 */		/* 0x0 */
+	'c','t',' ',LAST('a'),
+	'c','t',' ',LAST('b'),
+	'c','t',' ',LAST('c'),
+	'c','t',' ',LAST('d'),
+	'w','h','i','t',LAST('e'),
+	'c','t',' ',LAST('f'),
+	'c','t',' ',LAST('g'),
+	'c','t',' ',LAST('h'),	/* (disable charset switch (C64)) */
+	'c','t',' ',LAST('i'),	/* (enable charset switch (C64)) */
+	'c','t',' ',LAST('j'),	/* 10 */
+	'c','t',' ',LAST('k'),
+	'c','t',' ',LAST('l'),
+	'r','e','t','u','r',LAST('n'),
+	'c','t',' ',LAST('n'),
+	'c','t',' ',LAST('o'),
+	'c','t',' ',LAST('p'),	/* 0x10 */
+	'd','o','w',LAST('n'),
+	'r','e','v','e','r','s','e',' ','o',LAST('n'),
+	'h','o','m',LAST('e'),
+	'd','e','l','e','t',LAST('e'),	/* 20 */
+	'c','t',' ',LAST('u'),
+	'c','t',' ',LAST('v'),
+	'c','t',' ',LAST('w'),
+	'c','t',' ',LAST('x'),
+	'c','t',' ',LAST('y'),
+	'c','t',' ',LAST('z'),
+	'0','2',LAST('7'),		/* (c128) */
+	'r','e',LAST('d'),
+	'r','i','g','h',LAST('t'),
+	'g','r','e','e',LAST('n'),	/* 30 */
+	'b','l','u',LAST('e'),
+	LAST(' '),				/* (space) */				/* 0x20 */
+	LAST('!'),
+	LAST('"'),
+	LAST('#'),
+	LAST('$'),
+	LAST('%'),
+	LAST('&'),
+	LAST('\''),
+	LAST('('),				/* 40 */
+	LAST(')'),
+	LAST('*'),
+	LAST('+'),
+	LAST(','),
+	LAST('-'),
+	LAST('.'),
+	LAST('/'),
+	LAST('0'),				/* 0x30 */
+	LAST('1'),
+	LAST('2'),				/* 50 */
+	LAST('3'),
+	LAST('4'),
+	LAST('5'),
+	LAST('6'),
+	LAST('7'),
+	LAST('8'),
+	LAST('9'),
+	LAST(':'),
+	LAST(';'),
+	LAST('<'),				/* 60 */
+	LAST('='),
+	LAST('>'),
+	LAST('?'),
+	LAST('@'),				/* 0x40 */
+	LAST('a'),
+	LAST('b'),
+	LAST('c'),
+	LAST('d'),
+	LAST('e'),
+	LAST('f'),				/* 70 */
+	LAST('g'),
+	LAST('h'),
+	LAST('i'),
+	LAST('j'),
+	LAST('k'),
+	LAST('l'),
+	LAST('m'),
+	LAST('n'),
+	LAST('o'),
+	LAST('p'),				/* 80 */	/* 0x50 */
+	LAST('q'),
+	LAST('r'),
+	LAST('s'),
+	LAST('t'),
+	LAST('u'),
+	LAST('v'),
+	LAST('w'),
+	LAST('x'),
+	LAST('y'),
+	LAST('z'),				/* 90 */
+	LAST('['),
+	'p','o','u','n',LAST('d'),	/* pound */
+	LAST(']'),
+	LAST('^'),
+	'a','r','r','o','w',' ','l','e','f',LAST('t'),	/* <- */
+	'0','9',LAST('6'),		/* 0x60 */
+	'0','9',LAST('7'),
+	'0','9',LAST('8'),
+	'0','9',LAST('9'),
+	'1','0',LAST('0'),		/* 100 */
+	'1','0',LAST('1'),
+	'1','0',LAST('2'),
+	'1','0',LAST('3'),
+	'1','0',LAST('4'),
+	'1','0',LAST('5'),
+	'1','0',LAST('6'),
+	'1','0',LAST('7'),
+	'1','0',LAST('8'),
+	'1','0',LAST('9'),
+	'1','1',LAST('0'),		/* 110 */
+	'1','1',LAST('1'),
+	'1','1',LAST('2'),		/* 0x70 */
+	'1','1',LAST('3'),
+	'1','1',LAST('4'),
+	'1','1',LAST('5'),
+	'1','1',LAST('6'),
+	'1','1',LAST('7'),
+	'1','1',LAST('8'),
+	'1','1',LAST('9'),
+	'1','2',LAST('0'),		/* 120 */
+	'1','2',LAST('1'),
+	'1','2',LAST('2'),
+	'1','2',LAST('3'),
+	'1','2',LAST('4'),
+	'1','2',LAST('5'),
+	'1','2',LAST('6'),
+	'1','2',LAST('7'),
+	'1','2',LAST('8'),		/* 0x80 */
+	'o','r','a','n','g',LAST('e'),
+	'1','3',LAST('0'),		/* 130 */
+	'1','3',LAST('1'),
+	'1','3',LAST('2'),
+	'f',LAST('1'),
+	'f',LAST('3'),
+	'f',LAST('5'),
+	'f',LAST('7'),
+	'f',LAST('2'),
+	'f',LAST('4'),
+	'f',LAST('6'),
+	'f',LAST('8'),			/* 140 */
+	'1','4',LAST('1'),
+	'1','4',LAST('2'),
+	'1','4',LAST('3'),
+	'b','l','a','c',LAST('k'),	/* 0x90 */
+	'u',LAST('p'),
+	'r','e','v','e','r','s','e',' ','o','f',LAST('f'),
+	'c','l','e','a',LAST('r'),
+	'1','4',LAST('8'),		/* insert */
+	'b','r','o','w',LAST('n'),
+	'p','i','n',LAST('k'),	/* 150 */
+	'd','a','r','k',' ','g','r','a',LAST('y'),
+	'g','r','a',LAST('y'),
+	'l','i','g','h','t',' ','g','r','e','e',LAST('n'),
+	'l','i','g','h','t',' ','b','l','u',LAST('e'),
+	'l','i','g','h','t',' ','g','r','a',LAST('y'),
+	'1','5',LAST('6'),		/* run */
+	'l','e','f',LAST('t'),
+	'y','e','l','l','o',LAST('w'),
+	'c','y','a',LAST('n'),
+	's','h',' ','s','p','a','c',LAST('e'),	/* 160 */	/* 0xA0 */
+	'c','m',' ',LAST('k'),
+	'c','m',' ',LAST('i'),
+	'c','m',' ',LAST('t'),
+	'c','m',' ',LAST('@'),
+	'c','m',' ',LAST('g'),
+	'c','m',' ',LAST('+'),
+	'c','m',' ',LAST('m'),
+	'c','m',' ','p','o','u','n',LAST('d'),
+	's','h',' ','p','o','u','n',LAST('d'),
+	'c','m',' ',LAST('n'),	/* 170 */
+	'c','m',' ',LAST('q'),
+	'c','m',' ',LAST('d'),
+	'c','m',' ',LAST('z'),
+	'c','m',' ',LAST('s'),
+	'c','m',' ',LAST('p'),
+	'c','m',' ',LAST('a'),	/* 0xB0 */
+	'c','m',' ',LAST('e'),
+	'c','m',' ',LAST('r'),
+	'c','m',' ',LAST('w'),
+	'c','m',' ',LAST('h'),	/* 180 */
+	'c','m',' ',LAST('j'),
+	'c','m',' ',LAST('l'),
+	'c','m',' ',LAST('y'),
+	'c','m',' ',LAST('u'),
+	'c','m',' ',LAST('d'),
+	's','h',' ',LAST('@'),
+	'c','m',' ',LAST('f'),
+	'c','m',' ',LAST('c'),
+	'c','m',' ',LAST('x'),
+	'c','m',' ',LAST('v'),	/* 190 */
+	'c','m',' ',LAST('b'),
+	's','h',' ','a','s','t','e','r','i','s',LAST('k'),	/* 0xC0 */
+	LAST('A'),
+	LAST('B'),
+	LAST('C'),
+	LAST('D'),
+	LAST('E'),
+	LAST('F'),
+	LAST('G'),
+	LAST('H'),				/* 200 */
+	LAST('I'),
+	LAST('J'),
+	LAST('K'),
+	LAST('L'),
+	LAST('M'),
+	LAST('N'),
+	LAST('O'),
+	LAST('P'),				/* 0xD0 */
+	LAST('Q'),
+	LAST('R'),				/* 210 */
+	LAST('S'),
+	LAST('T'),
+	LAST('U'),
+	LAST('V'),
+	LAST('W'),
+	LAST('X'),
+	LAST('Y'),
+	LAST('Z'),
+	's','h',' ',LAST('+'),
+	'c','m',' ',LAST('-'),	/* 220 */
+	's','h',' ',LAST('-'),
+	'2','2',LAST('2'),
+	'c','m',' ','a','s','t','e','r','i','s',LAST('k'),
+	'2','2',LAST('4'),		/* 0xE0 */
+	'2','2',LAST('5'),
+	'2','2',LAST('6'),
+	'2','2',LAST('7'),
+	'2','2',LAST('8'),
+	'2','2',LAST('9'),
+	'2','3',LAST('0'),		/* 230 */
+	'2','3',LAST('1'),
+	'2','3',LAST('2'),
+	'2','3',LAST('3'),
+	'2','3',LAST('4'),
+	'2','3',LAST('5'),
+	'2','3',LAST('6'),
+	'2','3',LAST('7'),
+	'2','3',LAST('8'),
+	'2','3',LAST('9'),
+	'2','4',LAST('0'),		/* 240 */		/* 0xF0 */
+	'2','4',LAST('1'),
+	'2','4',LAST('2'),
+	'2','4',LAST('3'),
+	'2','4',LAST('4'),
+	'2','4',LAST('5'),
+	'2','4',LAST('6'),
+	'2','4',LAST('7'),
+	'2','4',LAST('8'),
+	'2','4',LAST('9'),
+	'2','5',LAST('0'),		/* 250 */
+	'2','5',LAST('1'),
+	'2','5',LAST('2'),
+	'2','5',LAST('3'),
+	'2','5',LAST('4'),
+	'p',LAST('i'),			/* 255 */		/* 0xFF */
+};
+
+/* Index to a packed table: the low byte of the offset of each entry, and
+ * the first entry that starts in each 256-byte page of the table. 1 byte
+ * per entry, where a pointer table takes 2, plus the terminators.
+ */
+typedef struct tokenindex_s {
+	const unsigned char *table_p;	/* packed table, NULL if left out of the build or not loaded */
+	unsigned short count;			/* entries */
+	unsigned char *offset_p;		/* low byte of the offset of each entry */
+	unsigned char pages;			/* pages the table spans. 0 until it is indexed */
+	unsigned short page_first[TOKEN_MAX_PAGES];	/* first entry in each page */
+} tokenindex_t;
+
+static unsigned char c64tokens_offsets[C64TOKENS_COUNT];
+static unsigned char petscii_offsets[256];
+
+#ifdef TOKENS_FILE
+
+/* One set of extension tables is in memory at a time: the tables of a
+ * dialect are loaded together, over the ones there were.
+ */
+#define TOKEN_POOL_SIZE		560	/* largest set: C128Tokens, C128CETokens and C128FETokens, 555 bytes */
+#define TOKEN_POOL_ENTRIES	(C128TOKENS_COUNT + C128CETOKENS_COUNT + C128FETOKENS_COUNT)
+
+static unsigned char token_pool[TOKEN_POOL_SIZE];
+static unsigned char token_pool_offsets[TOKEN_POOL_ENTRIES];
+
+/* in tokentable_t order */
+static const unsigned short token_counts[TOKEN_NUM_TABLES] = {
+	C64TOKENS_COUNT, GRAPHICS52TOKENS_COUNT, TFC3TOKENS_COUNT,
+	C128TOKENS_COUNT, C128CETOKENS_COUNT, C128FETOKENS_COUNT,
+	BASIC4TOKENS_COUNT, SUPERTOKENS_COUNT, 256
+};
+
+/* first table of the set each table is loaded with */
+static const unsigned char token_set[TOKEN_NUM_TABLES] = {
+	C64Tokens, Graphics52Tokens, TFC3Tokens,
+	C128Tokens, C128Tokens, C128Tokens,
+	Basic4Tokens, SuperTokens, PetsciiNames
+};
+
+/* tables that could not be loaded, so they aren't tried again */
+static unsigned char token_unavailable[TOKEN_NUM_TABLES];
+
+/* what tokentext() gives for a table that could not be loaded */
+static const unsigned char token_empty[1] = { EMPTY };
+
+/* in tokentable_t order. The extension tables are filled in by tokenload */
+static tokenindex_t tokenindex[TOKEN_NUM_TABLES] = {
+	{ c64tokens, C64TOKENS_COUNT, c64tokens_offsets },
+	{ NULL },
+	{ NULL },
+	{ NULL },
+	{ NULL },
+	{ NULL },
+	{ NULL },
+	{ NULL },
+	{ petscii, 256, petscii_offsets }
+};
+
+#else
+
+#ifndef NO_GRAPHICS52
+static unsigned char graphics52tokens_offsets[GRAPHICS52TOKENS_COUNT];
+#endif
+#ifndef NO_TFC3
+static unsigned char tfc3tokens_offsets[TFC3TOKENS_COUNT];
+#endif
+#ifndef NO_BASIC7
+static unsigned char c128tokens_offsets[C128TOKENS_COUNT];
+static unsigned char c128CEtokens_offsets[C128CETOKENS_COUNT];
+static unsigned char c128FEtokens_offsets[C128FETOKENS_COUNT];
+#endif
+#ifdef WITH_BASIC4
+static unsigned char basic4tokens_offsets[BASIC4TOKENS_COUNT];
+#endif
+#ifdef WITH_VICSUPER
+static unsigned char supertokens_offsets[SUPERTOKENS_COUNT];
+#endif
+
+/* in tokentable_t order */
+static tokenindex_t tokenindex[TOKEN_NUM_TABLES] = {
+	{ c64tokens, C64TOKENS_COUNT, c64tokens_offsets },
+#ifndef NO_GRAPHICS52
+	{ graphics52tokens, GRAPHICS52TOKENS_COUNT, graphics52tokens_offsets },
+#else
+	{ NULL },
+#endif
+#ifndef NO_TFC3
+	{ tfc3tokens, TFC3TOKENS_COUNT, tfc3tokens_offsets },
+#else
+	{ NULL },
+#endif
+#ifndef NO_BASIC7
+	{ c128tokens, C128TOKENS_COUNT, c128tokens_offsets },
+	{ c128CEtokens, C128CETOKENS_COUNT, c128CEtokens_offsets },
+	{ c128FEtokens, C128FETOKENS_COUNT, c128FEtokens_offsets },
+#else
+	{ NULL },
+	{ NULL },
+	{ NULL },
+#endif
+#ifdef WITH_BASIC4
+	{ basic4tokens, BASIC4TOKENS_COUNT, basic4tokens_offsets },
+#else
+	{ NULL },
+#endif
+#ifdef WITH_VICSUPER
+	{ supertokens, SUPERTOKENS_COUNT, supertokens_offsets },
+#else
+	{ NULL },
+#endif
+	{ petscii, 256, petscii_offsets }
+};
+
+#endif /* TOKENS_FILE */
+
+
+/* tokenbuild
+ * - builds the index of a packed table
+ * in:	index_p - index to fill in
+ * out:	none
+ */
+static void tokenbuild(tokenindex_t *index_p)
+{
+	const unsigned char *ch_p = index_p->table_p;
+	unsigned short offset;		/* offset of the entry in the table */
+	unsigned short i;			/* entry counter */
+
+	index_p->page_first[0] = 0;
+	index_p->pages = 1;
+
+	for (i = 0; i < index_p->count; i ++) {
+		offset = ch_p - index_p->table_p;
+
+		/* an entry is never longer than a page, so no page is skipped */
+		if ((offset >> 8) == index_p->pages) {
+			index_p->page_first[index_p->pages ++] = i;
+		} /* if */
+
+		index_p->offset_p[i] = (unsigned char) offset;
+
+		while (0 == (*(ch_p ++) & TOKEN_END_BIT)) {
+		} /* while */
+	} /* for */
+}
+
+
+#ifdef TOKENS_FILE
+/* tokenload
+ * - loads the set of extension tables a table belongs to from
+ *   TOKEN_FILENAME (see tokens.h), over the set that was in memory
+ * in:	table - table that is needed
+ * out:	TRUE / FALSE if the file could not be read, or has no such table
+ */
+static int tokenload(tokentable_t table)
+{
+	FILE *file;
+	unsigned char header[TOKEN_FILE_HEADER_SIZE];
+	unsigned short len[TOKEN_NUM_TABLES];	/* pool length of each table in the file */
+	unsigned short skip = 0;	/* bytes of pools before the set */
+	unsigned short need = 0;	/* bytes of pools in the set */
+	unsigned short entries = 0;	/* entries in the set */
+	unsigned short chunk;		/* bytes to skip in one read */
+	unsigned char first = token_set[table];
+	int ok = 0;
+	int i;						/* table counter */
+
+	file = fopen(TOKEN_FILENAME, "r");
+	if (NULL == file) {
+		return 0;
+	} /* if */
+
+	if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+	    TOKEN_FILE_MAGIC0 != header[0] || TOKEN_FILE_MAGIC1 != header[1] ||
+	    TOKEN_FILE_VERSION != header[2] || TOKEN_NUM_TABLES != header[3]) {
+		goto done;
+	} /* if */
+
+	for (i = 0; i < TOKEN_NUM_TABLES; i ++) {
+		len[i] = header[4 + 2 * i] | (header[5 + 2 * i] << 8);
+
+		if (i < first) {
+			skip += len[i];
+		} /* if */
+		else if (token_set[i] == first) {
+			need += len[i];
+			entries += token_counts[i];
+		} /* else */
+	} /* for */
+
+	if (0 == need || need > TOKEN_POOL_SIZE || entries > TOKEN_POOL_ENTRIES) {
+		goto done;
+	} /* if */
+
+	/* Skip the pools before the set by reading them into the pool: cc65
+	 * programs in this tree don't seek.
+	 */
+	while (skip) {
+		chunk = (skip > TOKEN_POOL_SIZE) ? TOKEN_POOL_SIZE : skip;
+		if (fread(token_pool, 1, chunk, file) != chunk) {
+			goto done;
+		} /* if */
+		skip -= chunk;
+	} /* while */
+
+	/* The set that was in memory is gone from here on */
+	for (i = C64Tokens + 1; i < PetsciiNames; i ++) {
+		tokenindex[i].table_p = NULL;
+	} /* for */
+
+	if (fread(token_pool, 1, need, file) != need) {
+		goto done;
+	} /* if */
+
+	need = 0;
+	entries = 0;
+	for (i = first; i < TOKEN_NUM_TABLES && token_set[i] == first; i ++) {
+		tokenindex[i].table_p = token_pool + need;
+		tokenindex[i].count = token_counts[i];
+		tokenindex[i].offset_p = token_pool_offsets + entries;
+		tokenindex[i].pages = 0;
+		need += len[i];
+		entries += token_counts[i];
+	} /* for */
+
+	ok = 1;
+
+done:
+	fclose(file);
+	return ok;
+}
+#endif
+
+
+/* tokentext
+ * - finds an entry of a packed table
+ * in:	table - table to look in
+ *		index - entry number (0 is the first entry)
+ * out:	packed text of the entry
+ */
+const unsigned char *tokentext(tokentable_t table, int index)
+{
+	tokenindex_t *index_p = &tokenindex[table];
+	unsigned char page = 0;		/* page of the table the entry starts in */
+
+#ifdef TOKENS_FILE
+	if (!tokenready(table)) {
+		return token_empty;
+	} /* if */
+#endif
+
+	if (0 == index_p->pages) {
+		tokenbuild(index_p);
+	} /* if */
+
+	while (page + 1 < index_p->pages && index >= index_p->page_first[page + 1]) {
+		page ++;
+	} /* while */
+
+	return index_p->table_p + ((unsigned short) page << 8) + index_p->offset_p[index];
+}
+
+
+/* tokenready
+ * - checks that the entries of a table can be used. With TOKENS_FILE,
+ *   the table is loaded if it isn't in memory
+ * in:	table - table that is needed
+ * out:	TRUE / FALSE if it is left out of the build, or could not be loaded
+ */
+int tokenready(tokentable_t table)
+{
+#ifdef TOKENS_FILE
+	if (NULL == tokenindex[table].table_p) {
+		if (token_unavailable[table]) {
+			return 0;
+		} /* if */
+
+		if (!tokenload(table)) {
+			fprintf(stderr, "* Could not load keywords from %s, left out\n",
+			        TOKEN_FILENAME);
+			token_unavailable[table] = 1;
+			return 0;
+		} /* if */
+	} /* if */
+#endif
+
+	return (NULL != tokenindex[table].table_p);
+}
+
+
+/* tokencount
+ * - gets the number of entries in a table
+ * in:	table - table to count
+ * out:	number of entries, 0 if the table is left out of the build, or
+ *		with TOKENS_FILE, not loaded
+ */
+int tokencount(tokentable_t table)
+{
+	return (NULL == tokenindex[table].table_p) ? 0 : tokenindex[table].count;
+}
+
+
+/* tokenlen
+ * - gets the length of a packed entry
+ * in:	text_p - packed text
+ * out:	number of characters
+ */
+int tokenlen(const unsigned char *text_p)
+{
+	int len = 1;				/* characters, counting the last */
+
+	if (EMPTY == *text_p) {
+		return 0;
+	} /* if */
+
+	while (0 == (*(text_p ++) & TOKEN_END_BIT)) {
+		len ++;
+	} /* while */
+
+	return len;
+}
+
+
+/* tokencopy
+ * - copies a packed entry as plain characters
+ * in:	output_p - where to write it. It is not null terminated.
+ *		text_p - packed text
+ * out:	number of characters written
+ */
+int tokencopy(char *output_p, const unsigned char *text_p)
+{
+	char *start_p = output_p;
+
+	if (EMPTY == *text_p) {
+		return 0;
+	} /* if */
+
+	while (0 == (*text_p & TOKEN_END_BIT)) {
+		*(output_p ++) = *(text_p ++);
+	} /* while */
+
+	*(output_p ++) = *text_p & ~TOKEN_END_BIT;
+
+	return output_p - start_p;
+}
+
+
+/* tokenmatch
+ * - checks whether a packed entry is exactly a string of len characters
+ * in:	text_p - packed text
+ *		string_p - characters to compare with (need not be null terminated)
+ *		len - number of characters at string_p
+ * out:	TRUE / FALSE
+ */
+int tokenmatch(const unsigned char *text_p, const char *string_p, int len)
+{
+	int i;						/* character counter */
+
+	if (tokenlen(text_p) != len) {
+		return 0;
+	} /* if */
+
+	for (i = 0; i < len; i ++) {
+		if ((text_p[i] & ~TOKEN_END_BIT) != (unsigned char) string_p[i]) {
+			return 0;
+		} /* if */
+	} /* for */
+
+	return 1;
+}
+
+/* PETSCII font codes
+ * - used in PETSCII font mode, with a font whose upper 128 glyphs hold the
+ *   PETSCII characters that do not exist in ASCII. Characters inside quotes
+ *   are written as the single font code, instead of as {escape}.
+ *   0x80-0x9F: reverse glyphs for control codes 0x01-0x1F
+ *              (0x80 = pound, 0x8D = arrow left, as null/return never occur)
+ *   0xA0-0xBF: reverse glyphs for control codes 0x80-0x9F
+ *   0xC0-0xDF: graphics 0xA0-0xBF (0xE0-0xFE are the same glyphs)
+ *   0xE0-0xFF: graphics 0x60-0x7F (0xC0, 0xDB-0xDF, 0xFF are the same glyphs)
+ * 0 => no font code, use the petscii name
+ */
+
+const unsigned char petscii_font[] = {
+	0x00, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x00, 0x8E, 0x8F,	/* 0x00 */
+	0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F,	/* 0x10 */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	/* 0x20 */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	/* 0x30 */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	/* 0x40 */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x8D,	/* 0x50 */
+	0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,	/* 0x60 */
+	0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF,	/* 0x70 */
+	0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0x00, 0xAE, 0xAF,	/* 0x80 */
+	0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,	/* 0x90 */
+	0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,	/* 0xA0 */
+	0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,	/* 0xB0 */
+	0xE0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	/* 0xC0 */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF,	/* 0xD0 */
+	0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,	/* 0xE0 */
+	0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xFE	/* 0xF0 */
 };
 
 /* tok64compatible
@@ -1,35 +1,87 @@
 #ifndef TOKENS_H
 #define TOKENS_H
 
+#include "detokenize.h"	/* dialects compiled in */
 
-/* C64 BASIC 2.0 */
-extern const char *c64tokens[];
 
-/* C64 Graphics52 BASIC extension (Software Unlimited) */
-extern const char *graphics52tokens[];
+/* number of entries in each token table */
+#define C64TOKENS_COUNT			76	/* 128-203 */
+#define GRAPHICS52TOKENS_COUNT	50	/* 204-253 */
+#define TFC3TOKENS_COUNT		29	/* 204-232 */
+#define C128TOKENS_COUNT		50	/* 204-253 */
+#define C128CETOKENS_COUNT		10	/* CE 00-09 */
+#define C128FETOKENS_COUNT		56	/* FE 00-37 */
+#define BASIC4TOKENS_COUNT		24	/* 204-227 */
+#define SUPERTOKENS_COUNT		18	/* 204-221 */
 
-/* C64 TFC3 BASIC extension (Riska BV) */
-extern const char *tfc3tokens[];
+/* Token and escape tables are packed the way the CBM ROM packs its
+ * keywords: each table is one pool of strings, with bit 7 set on the last
+ * character of each, and no terminator. An empty entry is the single byte
+ * TOKEN_END_BIT. Entries are found with tokentext(), through a small index
+ * built the first time a table is used.
+ */
+#define TOKEN_END_BIT			0x80
+
+typedef enum tokentable_e {
+	C64Tokens,				/* C64 BASIC 2.0 */
+	Graphics52Tokens,		/* C64 Graphics52 BASIC extension (Software Unlimited) */
+	TFC3Tokens,				/* C64 TFC3 BASIC extension (Riska BV) */
+	C128Tokens,				/* C128 BASIC 7.0, with Rick Simon's BASIC 7.1 extensions and C16/+4 BASIC 3.5 */
+	C128CETokens,
+	C128FETokens,
+	Basic4Tokens,			/* PET BASIC 4.0, with the C64 BASIC 4.0 extension */
+	SuperTokens,			/* VIC Super Expander */
+	PetsciiNames,			/* PETSCII characters and {escape} names */
+	TOKEN_NUM_TABLES
+} tokentable_t;
+
+/* packed text of entry index of a table (0 is the first entry: token 128
+ * for C64Tokens, 204 for the extensions). A table left out of the build
+ * (see detokenize.h) must not be used.
+ */
+const unsigned char *tokentext(tokentable_t table, int index);
 
-/* C128 BASIC 7.0
- * includes Rick Simon's BASIC 7.1 extensions
- * includes C16/+4 BASIC 3.5
+/* true if the entries of a table can be used: it is built in, or with
+ * TOKENS_FILE, could be loaded (it is loaded now if needed)
  */
-extern const char *c128tokens[];
-extern const char *c128CEtokens[];
-extern const char *c128FEtokens[];
+int tokenready(tokentable_t table);
 
-/* PET BASIC 4.0
- * includes C64 BASIC 4.0 extension
+/* number of entries in a table, 0 if it is left out of the build (or
+ * with TOKENS_FILE, not loaded)
  */
-extern const char *basic4tokens[];
+int tokencount(tokentable_t table);
+
+/* length of a packed entry */
+int tokenlen(const unsigned char *text_p);
+
+/* copy a packed entry as plain characters, not null terminated. returns
+ * the length.
+ */
+int tokencopy(char *output_p, const unsigned char *text_p);
+
+/* true if a packed entry is exactly the len characters at string_p */
+int tokenmatch(const unsigned char *text_p, const char *string_p, int len);
 
-/* VIC Super Extender
+/* With TOKENS_FILE defined, only the C64Tokens and PetsciiNames tables
+ * are built in. The extension tables are read from this file, one
+ * dialect's set at a time, the first time tokentext() needs them. The
+ * file is made by tools/mktokens.c:
+ *   2 bytes	TOKEN_FILE_MAGIC0, TOKEN_FILE_MAGIC1
+ *   1 byte		TOKEN_FILE_VERSION
+ *   1 byte		TOKEN_NUM_TABLES
+ *   2 bytes per table, in tokentable_t order, low byte first: length of
+ *				its pool. 0 for C64Tokens and PetsciiNames, and for tables
+ *				that were left out
+ *   the pools, in tokentable_t order
  */
-extern const char *supertokens[];
+#define TOKEN_FILENAME			"tokens.dat"
+#define TOKEN_FILE_MAGIC0		'B'
+#define TOKEN_FILE_MAGIC1		'T'
+#define TOKEN_FILE_VERSION		1
+#define TOKEN_FILE_HEADER_SIZE	(4 + 2 * TOKEN_NUM_TABLES)
 
 /* PETSCII */
-extern const char *petscii[];
+extern const unsigned char petscii_font[];
 int nontok64compatible(int petscii);
 
 
@@ -0,0 +1,105 @@
+/*
+ * mktokens.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+/* about this program
+ *
+ * Writes the token data file (TOKEN_FILENAME, see tokens.h) that a build with TOKENS_FILE defined loads its
+ * extension keyword tables from. It is built on the host, from the same tokens.c, without TOKENS_FILE, so the file
+ * always matches the tables in the source:
+ *
+ *   cc -DWITH_BASIC4 -DWITH_VICSUPER -o mktokens tools/mktokens.c tokens.c
+ *   ./mktokens tokens.dat
+ *
+ * Tables left out of the mktokens build (see detokenize.h) are written with length 0, and can't be loaded. Copy the
+ * file to the same drive as the program.
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+
+// project includes
+#include "../tokens.h"
+
+// C includes
+#include <stdint.h>
+#include <stdio.h>
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+int main(int argc, char* argv[])
+{
+	FILE*					the_file;
+	const unsigned char*	the_pool[TOKEN_NUM_TABLES];
+	uint16_t				the_len[TOKEN_NUM_TABLES];
+	const unsigned char*	the_last;
+	uint16_t				the_count;
+	uint8_t					i;
+
+	if (argc != 2)
+	{
+		fprintf(stderr, "usage: %s %s\n", argv[0], TOKEN_FILENAME);
+		return 1;
+	}
+
+	// LOGIC:
+	//   a pool runs from its first entry to the end bit of its last one. an empty entry is one byte.
+	//   C64Tokens and PetsciiNames are always built in, so they are not written.
+
+	for (i = 0; i < TOKEN_NUM_TABLES; i++)
+	{
+		the_count = tokencount(i);
+		the_len[i] = 0;
+
+		if (i == C64Tokens || i == PetsciiNames || the_count == 0)
+		{
+			continue;
+		}
+
+		the_pool[i] = tokentext(i, 0);
+		the_last = tokentext(i, the_count - 1);
+		the_len[i] = the_last - the_pool[i] + (tokenlen(the_last) > 0 ? tokenlen(the_last) : 1);
+	}
+
+	the_file = fopen(argv[1], "wb");
+
+	if (the_file == NULL)
+	{
+		fprintf(stderr, "Could not open %s for writing\n", argv[1]);
+		return 1;
+	}
+
+	fputc(TOKEN_FILE_MAGIC0, the_file);
+	fputc(TOKEN_FILE_MAGIC1, the_file);
+	fputc(TOKEN_FILE_VERSION, the_file);
+	fputc(TOKEN_NUM_TABLES, the_file);
+
+	for (i = 0; i < TOKEN_NUM_TABLES; i++)
+	{
+		fputc(the_len[i] & 0xFF, the_file);
+		fputc(the_len[i] >> 8, the_file);
+	}
+
+	for (i = 0; i < TOKEN_NUM_TABLES; i++)
+	{
+		if (the_len[i] > 0)
+		{
+			fwrite(the_pool[i], 1, the_len[i], the_file);
+			printf("table %u: %u entries, %u bytes\n", i, tokencount(i), the_len[i]);
+		}
+	}
+
+	fclose(the_file);
+
+	return 0;
+}
@@ -0,0 +1,343 @@
+/*
+ * verify.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+
+// project includes
+#include "verify.h"
+#include "detokenize.h"
+#include "lexer.h"
+#include "select.h"
+#include "tokenize.h"
+
+// C includes
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// cc65 includes
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define VERIFY_TEXT_BUFFER_SIZE		512		// same as the converter's: room for a 256 byte line with all chars escaped
+#define VERIFY_MAX_UNIT_LEN			16		// longest text of one item, without repeats: an {escape} name of 11, or a keyword
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+// reads the listing of a decoded line one character at a time, writing repeated characters out one by one
+typedef struct VerifyCursor
+{
+	LexerLine*			line_;
+	uint16_t			next_item_;
+	LexerItem			unit_item_;			// item being read, with its run set to 1
+	uint8_t				repeats_left_;		// times unit_ is still to be read after this one
+	uint8_t				pos_;
+	uint8_t				len_;
+	char				unit_[VERIFY_MAX_UNIT_LEN];
+} VerifyCursor;
+
+
+/*****************************************************************************/
+/*                          File-Scope Variables                             */
+/*****************************************************************************/
+
+// static because cc65 doesn't like creating that much on the stack. these are all the memory a verify uses.
+static uint8_t		verify_original[256];		// line number + tokenized line + null, as read from the file
+static uint8_t		verify_result[256];			// the same, after the round trip
+static char			verify_text[VERIFY_TEXT_BUFFER_SIZE];
+static LexerLine	verify_line;				// the original line, decoded
+static LexerLine	verify_result_line;			// the round trip result, decoded only if it differs
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+// open the file, skip the start address, and work out its dialect. the file is opened twice, as there is no fseek.
+// returns the open file positioned at the first line link, or NULL
+FILE* Verify_Open(char* the_filename, uint16_t* the_cbm_addr, basic_t* the_mode);
+
+// decode the original line into verify_line, and detokenize it into verify_text
+void Verify_Detokenize(basic_t mode, uint8_t flags);
+
+// get the next character of a line's listing
+// returns the character, or 0 at the end of the line
+char Verify_NextChar(VerifyCursor* the_cursor, uint8_t flags);
+
+// check whether the original line and its round trip result list the same, character for character
+bool Verify_ListsSame(basic_t mode, uint8_t flags);
+
+// find the first byte that differs between a line and its round trip result
+// returns the index of the byte, counting from the line number
+uint8_t Verify_FirstDifference(uint8_t original_len, uint8_t result_len);
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+
+// open the file, skip the start address, and work out its dialect. the file is opened twice, as there is no fseek.
+// returns the open file positioned at the first line link, or NULL
+FILE* Verify_Open(char* the_filename, uint16_t* the_cbm_addr, basic_t* the_mode)
+{
+	FILE*		the_file;
+	int16_t		addr_lo;
+	int16_t		addr_hi;
+	int			the_confidence;
+
+	the_file = fopen(the_filename, "r");
+
+	if (the_file == NULL)
+	{
+		return NULL;
+	}
+
+	addr_lo = fgetc(the_file);
+	addr_hi = fgetc(the_file);
+
+	if (addr_lo < 0 || addr_hi < 0)
+	{
+		fclose(the_file);
+		return NULL;
+	}
+
+	*the_cbm_addr = addr_lo + (addr_hi << 8);
+	*the_mode = detectbasic(the_file, *the_cbm_addr, &the_confidence);
+	fclose(the_file);
+
+	the_file = fopen(the_filename, "r");
+
+	if (the_file == NULL || fgetc(the_file) < 0 || fgetc(the_file) < 0)
+	{
+		if (the_file) fclose(the_file);
+		return NULL;
+	}
+
+	return the_file;
+}
+
+
+// decode the original line into verify_line, and detokenize it into verify_text
+void Verify_Detokenize(basic_t mode, uint8_t flags)
+{
+	LexerText	text_out;
+	LexerOutput	the_output;
+
+	text_out.buffer_ = verify_text;
+	text_out.flags_ = flags;
+	the_output.back_end_ = Lexer_TextBackEnd;
+	the_output.context_ = &text_out;
+
+	Lexer_Line(&verify_line, (const char*)verify_original, mode);
+	Lexer_Emit(&verify_line, &the_output, 1);
+}
+
+
+// get the next character of a line's listing
+// returns the character, or 0 at the end of the line
+char Verify_NextChar(VerifyCursor* the_cursor, uint8_t flags)
+{
+	while (the_cursor->pos_ == the_cursor->len_)
+	{
+		if (the_cursor->repeats_left_ > 0)
+		{
+			--the_cursor->repeats_left_;
+			the_cursor->pos_ = 0;
+			break;
+		}
+		
+		if (the_cursor->next_item_ == the_cursor->line_->num_items_)
+		{
+			return '\0';
+		}
+		
+		the_cursor->unit_item_ = the_cursor->line_->items_[the_cursor->next_item_++];
+		the_cursor->repeats_left_ = the_cursor->unit_item_.run_ - 1;
+		the_cursor->unit_item_.run_ = 1;
+		the_cursor->len_ = Lexer_ItemText(the_cursor->line_, &the_cursor->unit_item_, the_cursor->unit_, flags);
+		the_cursor->pos_ = 0;
+	}
+	
+	return the_cursor->unit_[the_cursor->pos_++];
+}
+
+
+// check whether the original line and its round trip result list the same, character for character
+bool Verify_ListsSame(basic_t mode, uint8_t flags)
+{
+	VerifyCursor	the_original;
+	VerifyCursor	the_result;
+	char			the_char;
+	
+	// LOGIC:
+	//   the listing text can't be compared as written, as {x*n} repeats group differently when two PETSCII codes show
+	//   as one character. writing whole lines without repeats could need several K per line, so instead both lines are
+	//   read one character at a time, each item written to a buffer of its own as it is reached.
+	
+	Lexer_Line(&verify_result_line, (const char*)verify_result, mode);
+	
+	memset(&the_original, 0, sizeof(VerifyCursor));
+	memset(&the_result, 0, sizeof(VerifyCursor));
+	the_original.line_ = &verify_line;
+	the_result.line_ = &verify_result_line;
+	
+	do
+	{
+		the_char = Verify_NextChar(&the_original, flags);
+		
+		if (the_char != Verify_NextChar(&the_result, flags))
+		{
+			return false;
+		}
+	} while (the_char != '\0');
+	
+	return (verify_line.line_number_ == verify_result_line.line_number_);
+}
+
+
+// find the first byte that differs between a line and its round trip result
+// returns the index of the byte, counting from the line number
+uint8_t Verify_FirstDifference(uint8_t original_len, uint8_t result_len)
+{
+	uint8_t		i;
+	uint8_t		the_shorter;
+	
+	the_shorter = (result_len < original_len) ? result_len : original_len;
+	
+	for (i = 0; i < the_shorter && verify_original[i] == verify_result[i]; i++);
+	
+	return i;
+}
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+//! Verify that a program file comes back unchanged after detokenizing and tokenizing each line
+//! The dialect is detected from the tokens the program uses, as for converting.
+//! @param	the_filename: name of the program file
+//! @param	flags: DETOKENIZE_FLAG_xxx options to write the text with
+//! @param	the_result: the outcome is returned here
+//! @return	Returns the_result->status_, one of VERIFY_xxx
+uint8_t Verify_File(char* the_filename, uint8_t flags, VerifyResult* the_result)
+{
+	FILE*		the_file;
+	uint16_t	cbm_addr;
+	uint16_t	nextadr;
+	int16_t		addr_lo;
+	int16_t		addr_hi;
+	uint8_t		the_len;
+	int16_t		result_len;
+	uint8_t		the_diff;
+
+	memset(the_result, 0, sizeof(VerifyResult));
+	the_result->status_ = VERIFY_BAD_FILE;
+
+	the_file = Verify_Open(the_filename, &cbm_addr, &the_result->mode_);
+
+	if (the_file == NULL)
+	{
+		return VERIFY_BAD_FILE;
+	}
+
+	the_result->file_offset_ = 2;	// start address
+	the_result->status_ = VERIFY_OK;
+
+	// LOGIC:
+	//   each line is read, detokenized into a buffer, and tokenized straight back, so the text never touches storage
+	//   and only one line is held at a time. only a line that doesn't come back byte for byte is decoded again.
+
+	while (true)
+	{
+		addr_lo = fgetc(the_file);
+		addr_hi = fgetc(the_file);
+
+		if (addr_lo < 0 || addr_hi < 0)
+		{
+			the_result->status_ = VERIFY_BAD_FILE;
+			break;
+		}
+
+		nextadr = addr_lo + (addr_hi << 8);
+
+		if (nextadr == 0)
+		{
+			// end of program
+			break;
+		}
+
+		// same checks as the converter: links go up, and a line is less than 256 bytes
+		if (nextadr <= cbm_addr || nextadr - cbm_addr >= 256 || nextadr - cbm_addr < 5)
+		{
+			the_result->status_ = VERIFY_BAD_FILE;
+			break;
+		}
+
+		the_len = nextadr - cbm_addr - 2;
+
+		if (fread(verify_original, 1, the_len, the_file) != the_len || verify_original[the_len - 1] != 0)
+		{
+			the_result->status_ = VERIFY_BAD_FILE;
+			break;
+		}
+
+		++the_result->lines_;
+		the_result->line_number_ = verify_original[0] + (verify_original[1] << 8);
+
+		Verify_Detokenize(the_result->mode_, flags);
+		result_len = tokenize(verify_text, verify_result, the_result->mode_);
+
+		if (result_len < 0)
+		{
+			the_result->status_ = VERIFY_BAD_TEXT;
+			break;
+		}
+
+		if (result_len != the_len || memcmp(verify_original, verify_result, the_len) != 0)
+		{
+			// LOGIC:
+			//   the text format can't tell some byte sequences apart: GO TO and GOTO, an operator kept as a plain
+			//   character and its token, INPUT # and INPUT#, or two PETSCII codes for one character. if both lines
+			//   list the same, character for character, the difference is one of those, not a conversion error.
+			if (Verify_ListsSame(the_result->mode_, flags) == false)
+			{
+				// the column skips the line number, the file offset adds the line link
+				the_diff = Verify_FirstDifference(the_len, result_len);
+				the_result->status_ = VERIFY_MISMATCH;
+				the_result->column_ = (the_diff < 2) ? 0 : the_diff - 2;
+				the_result->file_offset_ += 2 + the_diff;
+				the_result->original_byte_ = (the_diff < the_len) ? verify_original[the_diff] : -1;
+				the_result->result_byte_ = (the_diff < result_len) ? verify_result[the_diff] : -1;
+				break;
+			}
+			
+			++the_result->equivalent_lines_;
+			the_result->status_ = VERIFY_EQUIVALENT;
+		}
+
+		the_result->file_offset_ += 2 + the_len;
+		cbm_addr = nextadr;
+	}
+
+	fclose(the_file);
+
+	return the_result->status_;
+}
@@ -0,0 +1,81 @@
+/*
+ * verify.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+#ifndef VERIFY_H
+#define VERIFY_H
+
+/* about this module: Verify
+ *
+ * Checks that a program survives a round trip through text: each line is detokenized, the text is tokenized again,
+ * and the result is compared byte for byte with the original line. Nothing is written to storage, and the program is
+ * read one line at a time, so the memory used is the same for any size of program.
+ *
+ * Some differences are not errors: the text format has no way to tell GO TO from GOTO, an operator typed as a plain
+ * character from its token, or between PETSCII codes that show as the same character. A line that differs only in
+ * these ways is counted as equivalent and checking goes on. Otherwise, checking stops at the first byte that lists
+ * differently.
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "detokenize.h"
+
+// C includes
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+// results of a verify
+#define VERIFY_OK					0		// every line came back byte for byte
+#define VERIFY_EQUIVALENT			1		// some lines came back with different bytes, but list the same
+#define VERIFY_MISMATCH				2		// a line came back different (see first_diff_xxx)
+#define VERIFY_BAD_TEXT				3		// a line's text could not be tokenized again
+#define VERIFY_BAD_FILE				4		// the file could not be read, or is not a valid BASIC program
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct VerifyResult
+{
+	uint8_t				status_;			// VERIFY_xxx
+	basic_t				mode_;				// dialect the program was checked as
+	uint16_t			lines_;				// lines checked
+	uint16_t			equivalent_lines_;	// lines that differ only where the text format is ambiguous
+	uint16_t			line_number_;		// BASIC line number of the first mismatch or bad text
+	uint8_t				column_;			// byte of that line that differs, counting from the first byte after the line number
+	uint32_t			file_offset_;		// offset in the file of the byte that differs
+	int16_t				original_byte_;		// byte in the file, or -1 if the line is shorter than the result
+	int16_t				result_byte_;		// byte after the round trip, or -1 if the result is shorter than the line
+} VerifyResult;
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                          */
+/*****************************************************************************/
+
+//! Verify that a program file comes back unchanged after detokenizing and tokenizing each line
+//! The dialect is detected from the tokens the program uses, as for converting.
+//! @param	the_filename: name of the program file
+//! @param	flags: DETOKENIZE_FLAG_xxx options to write the text with
+//! @param	the_result: the outcome is returned here
+//! @return	Returns the_result->status_, one of VERIFY_xxx
+uint8_t Verify_File(char* the_filename, uint8_t flags, VerifyResult* the_result);
+
+
+#endif /* VERIFY_H */
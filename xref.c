@@ -0,0 +1,610 @@
+/*
+ * xref.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+
+// project includes
+#include "xref.h"
+#include "lexer.h"
+
+// C includes
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// cc65 includes
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+// tokens that are followed by line numbers (C64 BASIC 2.0, and BASIC 7.0 for ELSE, TRAP, RESUME)
+#define TOKEN_DATA					0x83
+#define TOKEN_GOTO					0x89
+#define TOKEN_RUN					0x8A
+#define TOKEN_RESTORE				0x8C
+#define TOKEN_GOSUB					0x8D
+#define TOKEN_REM					0x8F
+#define TOKEN_TO					0xA4
+#define TOKEN_FN					0xA5
+#define TOKEN_THEN					0xA7
+#define TOKEN_PLUS					0xAA
+#define TOKEN_MINUS					0xAB
+#define TOKEN_GO					0xCB
+#define TOKEN_C128_ELSE				0xD5
+#define TOKEN_C128_RESUME			0xD6
+#define TOKEN_C128_TRAP				0xD7
+
+// what the items after a keyword may be
+#define XREF_EXPECT_NONE			0
+#define XREF_EXPECT_ONE_TARGET		1		// a single line number: THEN 100, RUN 100
+#define XREF_EXPECT_TARGET_LIST		2		// line numbers separated by commas: GOTO 100, ON X GOSUB 100,200
+#define XREF_EXPECT_TO				3		// GO, which is a GOTO if followed by TO
+
+#define XREF_MAX_LINE_NUMBER		0xFFFF
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+// hash a line number or variable key to a bucket
+uint8_t Xref_Hash(uint16_t the_key);
+
+// record that the_line_number uses the_key, in the passed hash table
+void Xref_AddUse(Xref* the_xref, XrefEntry** the_table, uint16_t the_key, uint16_t the_line_number);
+
+// pack a variable name into a key that sorts alphabetically: first letter, second letter or digit, type, array flag
+uint16_t Xref_VarKey(uint8_t the_first, uint8_t the_second, uint8_t the_type, bool is_array);
+
+// write a variable key back out as the name it would have in the listing
+void Xref_WriteVarName(uint16_t the_key, FILE* the_file);
+
+// skip over space items. returns the first item that isn't a space, or the_end
+LexerItem* Xref_SkipSpaces(LexerItem* the_item, LexerItem* the_end);
+
+// read a number starting at the_item (a digit or '.'). spaces between digits are allowed in line numbers.
+// returns the item after the number, and the value (or XREF_MAX_LINE_NUMBER if too big, or not a whole number) in the_number
+LexerItem* Xref_ReadNumber(LexerItem* the_item, LexerItem* the_end, uint16_t* the_number);
+
+// read a variable name starting at the_item (a letter), and record its use
+// returns the item after the name
+LexerItem* Xref_ReadVariable(Xref* the_xref, LexerLine* the_line, LexerItem* the_item, LexerItem* the_end, bool is_fn);
+
+// write the entries of one hash table, sorted, each followed by the lines using it
+// returns false if there was not enough memory to sort them
+bool Xref_WriteTable(XrefEntry** the_table, uint16_t the_count, bool is_variables, FILE* the_file);
+
+// free every entry and use in one hash table
+void Xref_FreeTable(XrefEntry** the_table);
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+
+// hash a line number or variable key to a bucket
+uint8_t Xref_Hash(uint16_t the_key)
+{
+	// line numbers often go up in 10s, so the upper bits are mixed in to keep them from sharing buckets
+	return (uint8_t)(the_key ^ (the_key >> 6)) & (XREF_HASH_SIZE - 1);
+}
+
+
+// record that the_line_number uses the_key, in the passed hash table
+void Xref_AddUse(Xref* the_xref, XrefEntry** the_table, uint16_t the_key, uint16_t the_line_number)
+{
+	XrefEntry**	the_bucket = &the_table[Xref_Hash(the_key)];
+	XrefEntry*	the_entry;
+	XrefUse*	the_use;
+
+	for (the_entry = *the_bucket; the_entry != NULL; the_entry = the_entry->next_)
+	{
+		if (the_entry->key_ == the_key)
+		{
+			break;
+		}
+	}
+
+	if (the_entry == NULL)
+	{
+		the_entry = (XrefEntry*)calloc(1, sizeof(XrefEntry));
+
+		if (the_entry == NULL)
+		{
+			the_xref->out_of_memory_ = true;
+			return;
+		}
+
+		the_entry->key_ = the_key;
+		the_entry->next_ = *the_bucket;
+		*the_bucket = the_entry;
+
+		if (the_table == the_xref->targets_)
+		{
+			++the_xref->num_targets_;
+		}
+		else
+		{
+			++the_xref->num_variables_;
+		}
+	}
+
+	// lines arrive in order, so a line using the same thing twice only needs checking against the last use
+	if (the_entry->last_use_ != NULL && the_entry->last_use_->line_number_ == the_line_number)
+	{
+		return;
+	}
+
+	the_use = (XrefUse*)malloc(sizeof(XrefUse));
+
+	if (the_use == NULL)
+	{
+		the_xref->out_of_memory_ = true;
+		return;
+	}
+
+	the_use->line_number_ = the_line_number;
+	the_use->next_ = NULL;
+
+	if (the_entry->last_use_ == NULL)
+	{
+		the_entry->first_use_ = the_use;
+	}
+	else
+	{
+		the_entry->last_use_->next_ = the_use;
+	}
+
+	the_entry->last_use_ = the_use;
+}
+
+
+// pack a variable name into a key that sorts alphabetically: first letter, second letter or digit, type, array flag
+uint16_t Xref_VarKey(uint8_t the_first, uint8_t the_second, uint8_t the_type, bool is_array)
+{
+	uint16_t	the_second_code = 0;	// 0: no second character, 1-26: A-Z, 27-36: 0-9
+
+	if (the_second >= 'A' && the_second <= 'Z')
+	{
+		the_second_code = the_second - 'A' + 1;
+	}
+	else if (the_second >= '0' && the_second <= '9')
+	{
+		the_second_code = the_second - '0' + 27;
+	}
+
+	return ((uint16_t)(the_first - 'A') << 9) | (the_second_code << 3) | (the_type << 1) | (is_array ? 1 : 0);
+}
+
+
+// write a variable key back out as the name it would have in the listing
+void Xref_WriteVarName(uint16_t the_key, FILE* the_file)
+{
+	uint8_t		the_second_code = (the_key >> 3) & 0x3F;
+	uint8_t		the_type = (the_key >> 1) & 0x03;
+
+	if (the_type == XREF_VAR_FN)
+	{
+		fputs("FN ", the_file);
+	}
+
+	// variables are shown in lower case, as in the listing
+	fputc('a' + (the_key >> 9), the_file);
+
+	if (the_second_code > 26)
+	{
+		fputc('0' + the_second_code - 27, the_file);
+	}
+	else if (the_second_code > 0)
+	{
+		fputc('a' + the_second_code - 1, the_file);
+	}
+
+	if (the_type == XREF_VAR_STRING)
+	{
+		fputc('$', the_file);
+	}
+	else if (the_type == XREF_VAR_INTEGER)
+	{
+		fputc('%', the_file);
+	}
+
+	if (the_key & 1)
+	{
+		fputs("()", the_file);
+	}
+}
+
+
+// skip over space items. returns the first item that isn't a space, or the_end
+LexerItem* Xref_SkipSpaces(LexerItem* the_item, LexerItem* the_end)
+{
+	while (the_item < the_end && the_item->kind_ == LEXER_KIND_CHAR && the_item->value_ == ' ')
+	{
+		++the_item;
+	}
+
+	return the_item;
+}
+
+
+// read a number starting at the_item (a digit or '.'). spaces between digits are allowed in line numbers.
+// returns the item after the number, and the value (or XREF_MAX_LINE_NUMBER if too big, or not a whole number) in the_number
+LexerItem* Xref_ReadNumber(LexerItem* the_item, LexerItem* the_end, uint16_t* the_number)
+{
+	uint32_t	the_value = 0;
+	bool		is_whole = true;
+	LexerItem*	the_next;
+
+	while (the_item < the_end && the_item->kind_ == LEXER_KIND_CHAR)
+	{
+		if (the_item->value_ >= '0' && the_item->value_ <= '9')
+		{
+			the_value = (the_value * 10) + (the_item->value_ - '0');
+
+			if (the_value > XREF_MAX_LINE_NUMBER)
+			{
+				is_whole = false;
+				the_value = 0;
+			}
+		}
+		else if (the_item->value_ == '.')
+		{
+			is_whole = false;
+		}
+		else if (the_item->value_ == 'E')
+		{
+			// exponent: E, an optional + or - (which are tokens), then digits
+			is_whole = false;
+			the_next = the_item + 1;
+
+			if (the_next < the_end && the_next->kind_ == LEXER_KIND_KEYWORD &&
+			    (the_next->value_ == TOKEN_PLUS || the_next->value_ == TOKEN_MINUS))
+			{
+				the_item = the_next;
+			}
+		}
+		else if (the_item->value_ != ' ')
+		{
+			break;
+		}
+
+		++the_item;
+	}
+
+	*the_number = (is_whole) ? (uint16_t)the_value : XREF_MAX_LINE_NUMBER;
+
+	return the_item;
+}
+
+
+// read a variable name starting at the_item (a letter), and record its use
+// returns the item after the name
+LexerItem* Xref_ReadVariable(Xref* the_xref, LexerLine* the_line, LexerItem* the_item, LexerItem* the_end, bool is_fn)
+{
+	uint8_t		the_first = the_item->value_;
+	uint8_t		the_second = 0;
+	uint8_t		the_type = (is_fn) ? XREF_VAR_FN : XREF_VAR_FLOAT;
+	bool		is_array = false;
+	uint8_t		the_char;
+
+	// LOGIC:
+	//   a name runs as long as there are letters and digits; CBM BASIC only looks at the first two.
+	//   keywords inside a name (as in "FORT=" being FOR T=) were already split out by the tokenizer.
+
+	++the_item;
+
+	while (the_item < the_end && the_item->kind_ == LEXER_KIND_CHAR)
+	{
+		the_char = the_item->value_;
+
+		if ((the_char < 'A' || the_char > 'Z') && (the_char < '0' || the_char > '9'))
+		{
+			break;
+		}
+
+		if (the_second == 0)
+		{
+			the_second = the_char;
+		}
+
+		++the_item;
+	}
+
+	if (is_fn == false && the_item < the_end && the_item->kind_ == LEXER_KIND_CHAR)
+	{
+		if (the_item->value_ == '$')
+		{
+			the_type = XREF_VAR_STRING;
+			++the_item;
+		}
+		else if (the_item->value_ == '%')
+		{
+			the_type = XREF_VAR_INTEGER;
+			++the_item;
+		}
+	}
+
+	if (is_fn == false && the_item < the_end && the_item->kind_ == LEXER_KIND_CHAR && the_item->value_ == '(')
+	{
+		is_array = true;
+	}
+
+	Xref_AddUse(the_xref, the_xref->variables_, Xref_VarKey(the_first, the_second, the_type, is_array), the_line->line_number_);
+
+	return the_item;
+}
+
+
+// write the entries of one hash table, sorted, each followed by the lines using it
+// returns false if there was not enough memory to sort them
+bool Xref_WriteTable(XrefEntry** the_table, uint16_t the_count, bool is_variables, FILE* the_file)
+{
+	XrefEntry**		the_sorted;
+	XrefEntry*		the_entry;
+	XrefUse*		the_use;
+	uint16_t		i;
+	uint16_t		j;
+	uint8_t			the_bucket;
+
+	if (the_count == 0)
+	{
+		return true;
+	}
+
+	the_sorted = (XrefEntry**)malloc(the_count * sizeof(XrefEntry*));
+
+	if (the_sorted == NULL)
+	{
+		return false;
+	}
+
+	// insertion sort as the entries are gathered from the buckets: tables are small, and this needs no extra memory
+	i = 0;
+
+	for (the_bucket = 0; the_bucket < XREF_HASH_SIZE; the_bucket++)
+	{
+		for (the_entry = the_table[the_bucket]; the_entry != NULL; the_entry = the_entry->next_)
+		{
+			for (j = i; j > 0 && the_sorted[j - 1]->key_ > the_entry->key_; j--)
+			{
+				the_sorted[j] = the_sorted[j - 1];
+			}
+
+			the_sorted[j] = the_entry;
+			++i;
+		}
+	}
+
+	for (i = 0; i < the_count; i++)
+	{
+		if (is_variables)
+		{
+			Xref_WriteVarName(the_sorted[i]->key_, the_file);
+			fputc(':', the_file);
+		}
+		else
+		{
+			fprintf(the_file, "%u:", the_sorted[i]->key_);
+		}
+
+		for (the_use = the_sorted[i]->first_use_; the_use != NULL; the_use = the_use->next_)
+		{
+			fprintf(the_file, " %u", the_use->line_number_);
+		}
+
+		fputc('\n', the_file);
+	}
+
+	free(the_sorted);
+
+	return true;
+}
+
+
+// free every entry and use in one hash table
+void Xref_FreeTable(XrefEntry** the_table)
+{
+	XrefEntry*		the_entry;
+	XrefEntry*		the_next_entry;
+	XrefUse*		the_use;
+	XrefUse*		the_next_use;
+	uint8_t			the_bucket;
+
+	for (the_bucket = 0; the_bucket < XREF_HASH_SIZE; the_bucket++)
+	{
+		for (the_entry = the_table[the_bucket]; the_entry != NULL; the_entry = the_next_entry)
+		{
+			for (the_use = the_entry->first_use_; the_use != NULL; the_use = the_next_use)
+			{
+				the_next_use = the_use->next_;
+				free(the_use);
+			}
+
+			the_next_entry = the_entry->next_;
+			free(the_entry);
+		}
+
+		the_table[the_bucket] = NULL;
+	}
+}
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+//! Create an empty cross-reference
+//! @return	Returns a pointer to the new Xref, or NULL if it could not be allocated
+Xref* Xref_New(void)
+{
+	return (Xref*)calloc(1, sizeof(Xref));
+}
+
+
+//! Free a cross-reference and everything recorded in it
+//! @param	the_xref: pointer to the pointer to the Xref. It is set to NULL.
+void Xref_Destroy(Xref** the_xref)
+{
+	if (*the_xref == NULL)
+	{
+		return;
+	}
+
+	Xref_FreeTable((*the_xref)->targets_);
+	Xref_FreeTable((*the_xref)->variables_);
+	free(*the_xref);
+	*the_xref = NULL;
+}
+
+
+//! Back-end: record the line targets and variables used in a decoded line. the_context: Xref*
+void Xref_BackEnd(LexerLine* the_line, void* the_context)
+{
+	Xref*			the_xref = (Xref*)the_context;
+	LexerItem*		the_item = the_line->items_;
+	LexerItem*		the_end = the_item + the_line->num_items_;
+	bool			is_c128 = (Basic7 == the_line->mode_ || Basic71 == the_line->mode_);
+	uint8_t			expecting = XREF_EXPECT_NONE;
+	uint8_t			the_value;
+	uint16_t		the_number;
+
+	// LOGIC:
+	//   strings are already separate items, so only keywords and characters outside quotes are looked at.
+	//   a keyword that takes line numbers sets what is expected next; anything else clears it.
+	//   REM ends the line, and DATA is skipped up to the next colon.
+
+	while (the_item < the_end)
+	{
+		the_value = the_item->value_;
+
+		if (the_item->kind_ == LEXER_KIND_KEYWORD)
+		{
+			if (the_value == TOKEN_REM)
+			{
+				return;
+			}
+
+			++the_item;
+
+			if (the_value == TOKEN_DATA)
+			{
+				while (the_item < the_end && !(the_item->kind_ == LEXER_KIND_CHAR && the_item->value_ == ':'))
+				{
+					++the_item;
+				}
+
+				expecting = XREF_EXPECT_NONE;
+			}
+			else if (the_value == TOKEN_FN)
+			{
+				the_item = Xref_SkipSpaces(the_item, the_end);
+
+				if (the_item < the_end && the_item->kind_ == LEXER_KIND_CHAR && the_item->value_ >= 'A' && the_item->value_ <= 'Z')
+				{
+					the_item = Xref_ReadVariable(the_xref, the_line, the_item, the_end, true);
+				}
+
+				expecting = XREF_EXPECT_NONE;
+			}
+			else if (the_value == TOKEN_GOTO || the_value == TOKEN_GOSUB || (the_value == TOKEN_TO && expecting == XREF_EXPECT_TO))
+			{
+				expecting = XREF_EXPECT_TARGET_LIST;
+			}
+			else if (the_value == TOKEN_THEN || the_value == TOKEN_RUN || the_value == TOKEN_RESTORE ||
+			         (is_c128 && (the_value == TOKEN_C128_ELSE || the_value == TOKEN_C128_RESUME || the_value == TOKEN_C128_TRAP)))
+			{
+				expecting = XREF_EXPECT_ONE_TARGET;
+			}
+			else if (the_value == TOKEN_GO)
+			{
+				expecting = XREF_EXPECT_TO;
+			}
+			else
+			{
+				expecting = XREF_EXPECT_NONE;
+			}
+
+			continue;
+		}
+
+		if (the_item->kind_ == LEXER_KIND_CHAR)
+		{
+			if (the_value == ' ')
+			{
+				++the_item;
+				continue;
+			}
+
+			if ((the_value >= '0' && the_value <= '9') || the_value == '.')
+			{
+				the_item = Xref_ReadNumber(the_item, the_end, &the_number);
+
+				if ((expecting == XREF_EXPECT_ONE_TARGET || expecting == XREF_EXPECT_TARGET_LIST) && the_number != XREF_MAX_LINE_NUMBER)
+				{
+					Xref_AddUse(the_xref, the_xref->targets_, the_number, the_line->line_number_);
+				}
+
+				if (expecting != XREF_EXPECT_TARGET_LIST)
+				{
+					expecting = XREF_EXPECT_NONE;
+				}
+
+				continue;
+			}
+
+			if (the_value == ',' && expecting == XREF_EXPECT_TARGET_LIST)
+			{
+				++the_item;
+				continue;
+			}
+
+			if (the_value >= 'A' && the_value <= 'Z')
+			{
+				the_item = Xref_ReadVariable(the_xref, the_line, the_item, the_end, false);
+				expecting = XREF_EXPECT_NONE;
+				continue;
+			}
+		}
+
+		expecting = XREF_EXPECT_NONE;
+		++the_item;
+	}
+}
+
+
+//! Write the cross-reference report: line targets first, then variables, each followed by the lines using them
+//! @param	the_xref: valid pointer to an Xref
+//! @param	the_file: open file to write to
+//! @return	Returns false if there was not enough memory to sort the entries
+bool Xref_WriteReport(Xref* the_xref, FILE* the_file)
+{
+	bool		the_result;
+
+	fprintf(the_file, "LINE TARGETS (%u)\n", the_xref->num_targets_);
+	the_result = Xref_WriteTable(the_xref->targets_, the_xref->num_targets_, false, the_file);
+
+	fprintf(the_file, "\nVARIABLES (%u)\n", the_xref->num_variables_);
+	the_result &= Xref_WriteTable(the_xref->variables_, the_xref->num_variables_, true, the_file);
+
+	if (the_xref->out_of_memory_)
+	{
+		fprintf(the_file, "\n(out of memory: some references are missing)\n");
+	}
+
+	return the_result;
+}
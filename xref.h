@@ -0,0 +1,101 @@
+/*
+ * xref.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+#ifndef XREF_H
+#define XREF_H
+
+/* about this module: Xref
+ *
+ * Builds a cross-reference of a BASIC program while it is being converted: which line numbers are jumped to
+ * (GOTO, GOSUB, THEN, ON..GOTO/GOSUB, GO TO, RUN, RESTORE, and C128 ELSE/TRAP/RESUME) and from which lines, and
+ * which variables are used on which lines.
+ *
+ * It is a lexer back-end (see lexer.h): it reads the items the converter has already decoded for each line, so no
+ * second pass over the program is needed. References are kept in two small hash tables, keyed by line number and by
+ * variable name. Only the first two characters of a variable name count, as in CBM BASIC, so COUNT and CO are the
+ * same variable. The report lists both tables sorted, as text.
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lexer.h"
+
+// C includes
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define XREF_HASH_SIZE				64		// buckets in each hash table. must be a power of 2
+
+// variable types, stored in the variable key
+#define XREF_VAR_FLOAT				0
+#define XREF_VAR_STRING				1		// name$
+#define XREF_VAR_INTEGER			2		// name%
+#define XREF_VAR_FN					3		// FN name
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct XrefUse
+{
+	uint16_t			line_number_;		// line the reference is on
+	struct XrefUse*		next_;
+} XrefUse;
+
+typedef struct XrefEntry
+{
+	uint16_t			key_;				// target line number, or packed variable name (see Xref_VarKey())
+	XrefUse*			first_use_;
+	XrefUse*			last_use_;
+	struct XrefEntry*	next_;				// next entry in the same hash bucket
+} XrefEntry;
+
+typedef struct Xref
+{
+	XrefEntry*			targets_[XREF_HASH_SIZE];
+	XrefEntry*			variables_[XREF_HASH_SIZE];
+	uint16_t			num_targets_;
+	uint16_t			num_variables_;
+	bool				out_of_memory_;		// true if some references could not be recorded
+} Xref;
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                          */
+/*****************************************************************************/
+
+//! Create an empty cross-reference
+//! @return	Returns a pointer to the new Xref, or NULL if it could not be allocated
+Xref* Xref_New(void);
+
+//! Free a cross-reference and everything recorded in it
+//! @param	the_xref: pointer to the pointer to the Xref. It is set to NULL.
+void Xref_Destroy(Xref** the_xref);
+
+//! Back-end: record the line targets and variables used in a decoded line. the_context: Xref*
+void Xref_BackEnd(LexerLine* the_line, void* the_context);
+
+//! Write the cross-reference report: line targets first, then variables, each followed by the lines using them
+//! @param	the_xref: valid pointer to an Xref
+//! @param	the_file: open file to write to
+//! @return	Returns false if there was not enough memory to sort the entries
+bool Xref_WriteReport(Xref* the_xref, FILE* the_file);
+
+
+#endif /* XREF_H */